@@ -22,6 +22,8 @@ static const char* dfltExt = ".new";
 
 static bool verbose = true; /* if true don't number of characters processed. */
 static bool debug = false;
+static bool stats = false;
+static bool analytic = false;
 
 static void
 printVersions(void)
@@ -35,8 +37,8 @@ printUsage(void)
 {
     fprintf(stdout, "Usage: autohintexe [-u] [-h]\n");
     fprintf(stdout, "       autohintexe  -f <font info name> [-e] [-n] "
-                    "[-q] [-s <suffix>] [-ra] [-rs] -a] [<file1> <file2> "
-                    "... <filen>]\n");
+                    "[-q] [-s <suffix>] [-ra] [-rs] -a] [-stats] [-analytic] "
+                    "[<file1> <file2> ... <filen>]\n");
     printVersions();
 }
 
@@ -67,9 +69,33 @@ printHelp(void)
                     "change glyph. Default extension is '.rpt'\n");
     fprintf(stdout, "   -a Modifies -ra and -rs: Includes stems between "
                     "curved lines: default is to omit these.\n");
+    fprintf(stdout, "   -stats print the time spent in each phase of the "
+                    "hinting and some counts for every glyph\n");
+    fprintf(stdout, "   -analytic find the bounding boxes of curves from "
+                    "their extremes instead of by flattening them\n");
     fprintf(stdout, "   -v print versions.\n");
 }
 
+static void
+printStats(const ACStats* st)
+{
+    fprintf(stderr,
+            "STATS: %s read %.3f pregen %.3f genh %.3f genv %.3f evalh %.3f "
+            "evalv %.3f pruneh %.3f prunev %.3f merge %.3f extra %.3f "
+            "shuffle %.3f save %.3f ms\n",
+            st->glyphName, st->readGlyphNs / 1e6, st->preGenPtsNs / 1e6,
+            st->genHPtsNs / 1e6, st->genVPtsNs / 1e6, st->evalHNs / 1e6,
+            st->evalVNs / 1e6, st->pruneHValsNs / 1e6,
+            st->pruneVValsNs / 1e6, st->mergeValsNs / 1e6,
+            st->autoExtraHintsNs / 1e6, st->shuffleSubpathsNs / 1e6,
+            st->saveFileNs / 1e6);
+    fprintf(stderr,
+            "STATS: %s segments %zu values %zu pruned %zu hintsets %zu "
+            "retries %zu arena %zu\n",
+            st->glyphName, st->segments, st->candidateValues,
+            st->prunedValues, st->hintSets, st->retries, st->arenaBytes);
+}
+
 static void
 charZoneCB(float top, float bottom, char* glyphName, void* userData)
 {
@@ -237,6 +263,9 @@ main(int argc, char* argv[])
     int total_files = 0;
     int result, argi;
     ACBuffer* reportBuffer = NULL;
+    ACBuffer* output = NULL;
+    ACContext* ctx = NULL;
+    ACStats glyphStats;
 
     badParam = false;
     allStems = false;
@@ -260,6 +289,12 @@ main(int argc, char* argv[])
             fprintf(stderr, "ERROR: Illegal command line. \"-\" option "
                             "found after first file name.\n");
             exit(1);
+        } else if (strcmp(current_arg, "-stats") == 0) {
+            stats = true;
+            continue;
+        } else if (strcmp(current_arg, "-analytic") == 0) {
+            analytic = true;
+            continue;
         }
 
         switch (current_arg[1]) {
@@ -393,26 +428,39 @@ main(int argc, char* argv[])
         exit(AC_InvalidParameterError);
 
     AC_SetReportCB(reportCB);
+    AC_SetLogLevel(debug ? AC_LogDebug : verbose ? AC_LogInfo : AC_LogError);
     argi = firstFileNameIndex - 1;
     if (!doMM) {
+        ctx = ACContextNew();
+        if (ctx == NULL) {
+            fprintf(stderr, "ERROR: Could not allocate hinting context.\n");
+            exit(AC_FatalError);
+        }
+        if (stats)
+            ACContextSetStats(ctx, &glyphStats);
+        ACContextSetAnalyticBBox(ctx, analytic);
+        /* one output buffer for all the glyphs */
+        output = ACBufferNew(4096);
         while (++argi < argc) {
             char* bezdata;
-            ACBuffer* output;
             char* bezName = argv[argi];
             if (!argumentIsBezData) {
                 bezdata = getFileData(bezName);
             } else {
                 bezdata = bezName;
             }
-            output = ACBufferNew(4 * strlen(bezdata));
+            ACBufferReset(output);
+            ACBufferReserve(output, 4 * strlen(bezdata));
 
             if (reportBuffer)
                 ACBufferReset(reportBuffer);
 
-            result = AutoHintString(bezdata, fontinfo, output, allowEdit,
-                                    allowHintSub, roundCoords);
+            result = AutoHintStringCtx(ctx, bezdata, fontinfo, output,
+                                       allowEdit, allowHintSub, roundCoords);
             if (!argumentIsBezData)
                 free(bezdata);
+            if (stats)
+                printStats(&glyphStats);
 
             if (result == AC_Success) {
                 char* data;
@@ -435,11 +483,12 @@ main(int argc, char* argv[])
                 }
             }
 
-            ACBufferFree(output);
-            output=NULL;
             if (result != AC_Success)
                 exit(result);
         }
+        ACBufferFree(output);
+        ACContextFree(ctx);
+        ctx = NULL;
     } else /* assume files are MM bez files */
     {
         /** MM support */
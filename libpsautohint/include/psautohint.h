@@ -19,6 +19,7 @@
 #define PSAUTOHINT_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,11 +56,23 @@ enum
 };
 
 
+/*
+ * The hinting functions append their output to an ACBuffer, and only
+ * allocate when it outgrows the buffer. A buffer that is reset and reused for
+ * every glyph (or reserved with ACBufferReserve() up front) saves allocating
+ * one per glyph.
+ *
+ * ACBufferWrap() makes a buffer that writes to the size bytes at data, which
+ * the caller keeps owning. If the output outgrows them it is moved to memory
+ * allocated by the buffer, so ACBufferRead() must be used to find it.
+ */
 typedef struct ACBuffer ACBuffer;
 
 ACLIB_API ACBuffer* ACBufferNew(size_t size);
+ACLIB_API ACBuffer* ACBufferWrap(char* data, size_t size);
 ACLIB_API void ACBufferFree(ACBuffer* buffer);
 ACLIB_API void ACBufferReset(ACBuffer* buffer);
+ACLIB_API void ACBufferReserve(ACBuffer* buffer, size_t size);
 ACLIB_API void ACBufferWrite(ACBuffer* buffer, char* data, size_t length);
 ACLIB_API void ACBufferWriteF(ACBuffer* buffer, char* format, ...);
 ACLIB_API void ACBufferRead(ACBuffer* buffer, char** data, size_t* length);
@@ -87,11 +100,25 @@ ACLIB_API void AC_SetMemManager(void* ctxptr, AC_MEMMANAGEFUNCPTR func);
  * If this is supplied, then the AC lib will use this call back to report
  * messages.
  *
+ * This and the other AC_Set*CB functions below set process-wide defaults.
+ * AutoHintString() and AutoHintStringMM() use them as they are at the time of
+ * the call, and contexts created with ACContextNew() start with a copy of
+ * them, see ACContextSetReportCB() and the like for setting the callbacks of
+ * a single context. Set them before hinting starts on other threads.
  */
 typedef void (*AC_REPORTFUNCPTR)(char* msg, int level);
 
 ACLIB_API void AC_SetReportCB(AC_REPORTFUNCPTR reportCB);
 
+/*
+ * Function: AC_SetLogLevel
+ *
+ * Messages below level (one of the AC_Log* values) are not formatted nor
+ * passed to the report call back. The default is AC_LogDebug, which reports
+ * everything. Like the call backs, this is a process-wide default.
+ */
+ACLIB_API void AC_SetLogLevel(int level);
+
 /*
  * Function: AC_SetReportStemsCB
  *
@@ -159,6 +186,9 @@ ACLIB_API void AC_SetReportRetryCB(AC_RETRYPTR retryCB, void* userData);
  * the buffer dstbezdata. dstbezdata must be allocated before the call and a
  * pointer to its length passed as *length. If the space allocated is
  * insufficient for the target bezdata, it will be reallocated as needed.
+ *
+ * This function uses a default context shared by all callers, see
+ * AutoHintStringCtx() for hinting from several threads.
  */
 ACLIB_API int AutoHintString(const char* srcbezdata, const char* fontinfo,
                              ACBuffer* outbuffer, int allowEdit,
@@ -171,11 +201,296 @@ ACLIB_API int AutoHintString(const char* srcbezdata, const char* fontinfo,
 ACLIB_API int AutoHintStringMM(const char** srcbezdata, int nmasters,
                                const char** masters, ACBuffer** outbuffers);
 
+/*
+ * Function: ACContextNew
+ *
+ * Creates a hinting context. A context holds all the state the AC lib uses
+ * while hinting a glyph, so glyphs can be hinted concurrently from several
+ * threads as long as each thread uses its own context. A context can be
+ * reused for any number of glyphs, but must not be used by two threads at
+ * the same time.
+ *
+ * The memory manager set with AC_SetMemManager() is shared by all threads.
+ * The other callbacks are copied from the ones set with the AC_Set*CB
+ * functions, and can then be changed for this context alone.
+ *
+ * Returns NULL if the context could not be allocated.
+ */
+typedef struct ACContext ACContext;
+
+ACLIB_API ACContext* ACContextNew(void);
+
+/*
+ * Function: ACContextFree
+ *
+ * Frees a context created with ACContextNew().
+ */
+ACLIB_API void ACContextFree(ACContext* ctx);
+
+/*
+ * Functions: ACContextSetReportCB etc.
+ *
+ * Same as the AC_Set*CB functions and AC_SetLogLevel(), but only for the
+ * glyphs hinted with ctx, so that each thread can report to its own buffers.
+ * ACContextResetCallbacks() sets the callbacks of ctx back to the
+ * process-wide ones.
+ */
+ACLIB_API void ACContextSetReportCB(ACContext* ctx, AC_REPORTFUNCPTR reportCB);
+ACLIB_API void ACContextSetLogLevel(ACContext* ctx, int level);
+ACLIB_API void ACContextSetReportStemsCB(ACContext* ctx,
+                                         AC_REPORTSTEMPTR hstemCB,
+                                         AC_REPORTSTEMPTR vstemCB,
+                                         unsigned int allStems,
+                                         void* userData);
+ACLIB_API void ACContextSetReportZonesCB(ACContext* ctx,
+                                         AC_REPORTZONEPTR charCB,
+                                         AC_REPORTZONEPTR stemCB,
+                                         void* userData);
+ACLIB_API void ACContextSetReportRetryCB(ACContext* ctx, AC_RETRYPTR retryCB,
+                                         void* userData);
+ACLIB_API void ACContextResetCallbacks(ACContext* ctx);
+
+/*
+ * Function: AutoHintStringCtx
+ *
+ * Same as AutoHintString(), but uses the given context instead of the default
+ * one.
+ */
+ACLIB_API int AutoHintStringCtx(ACContext* ctx, const char* srcbezdata,
+                                const char* fontinfo, ACBuffer* outbuffer,
+                                int allowEdit, int allowHintSub,
+                                int roundCoords);
+
+/*
+ * Function: AutoHintStringMMCtx
+ *
+ * Same as AutoHintStringMM(), but uses the given context instead of the
+ * default one.
+ */
+ACLIB_API int AutoHintStringMMCtx(ACContext* ctx, const char** srcbezdata,
+                                  int nmasters, const char** masters,
+                                  ACBuffer** outbuffers);
+
+/*
+ * Function: ACFontInfoNew
+ *
+ * Parses fontinfo, a pointer to null terminated C string containing fontinfo
+ * data, and decodes the alignment zones, stems and other values used for
+ * hinting, so that this is done once for all the glyphs using the font info
+ * rather than for each of them. The result is only read while hinting, and
+ * can be shared by several threads.
+ *
+ * Returns NULL if the font info could not be allocated.
+ */
+typedef struct ACFontInfo ACFontInfo;
+
+ACLIB_API ACFontInfo* ACFontInfoNew(const char* fontinfo);
+
+/*
+ * Function: ACFontInfoFree
+ *
+ * Frees a font info created with ACFontInfoNew().
+ */
+ACLIB_API void ACFontInfoFree(ACFontInfo* info);
+
+/*
+ * Function: AutoHintStringWithInfo
+ *
+ * Same as AutoHintStringCtx(), but with a font info created with
+ * ACFontInfoNew() instead of the fontinfo string.
+ */
+ACLIB_API int AutoHintStringWithInfo(ACContext* ctx, const char* srcbezdata,
+                                     const ACFontInfo* fontinfo,
+                                     ACBuffer* outbuffer, int allowEdit,
+                                     int allowHintSub, int roundCoords);
+
+/*
+ * Path operators of ACPathElement.
+ */
+enum
+{
+    AC_MoveTo,
+    AC_LineTo,
+    AC_CurveTo,
+    AC_ClosePath
+};
+
+/*
+ * Flags of ACPathElement.
+ */
+enum
+{
+    AC_FlexCurve = 1 /* the curve is one of the two curves of a flex */
+};
+
+/*
+ * An element of a glyph path, op is one of AC_MoveTo etc. The coordinates are
+ * absolute, in 24.8 fixed point (the value times 256): x, y for AC_MoveTo and
+ * AC_LineTo, the two control points and the end point for AC_CurveTo, and
+ * none for AC_ClosePath. The flags are set in hinting results, and ignored
+ * in the input.
+ */
+typedef struct
+{
+    int op;
+    int flags;
+    int32_t coords[6];
+} ACPathElement;
+
+/*
+ * Function: AutoHintPath
+ *
+ * Same as AutoHintStringWithInfo(), but takes the glyph as the name and the
+ * length elements of path instead of bez data, which saves formatting the
+ * glyph as text and parsing it again. The hinted glyph is written to
+ * outbuffer as bez data.
+ */
+ACLIB_API int AutoHintPath(ACContext* ctx, const char* glyphname,
+                           const ACPathElement* path, size_t length,
+                           const ACFontInfo* fontinfo, ACBuffer* outbuffer,
+                           int allowEdit, int allowHintSub, int roundCoords);
+
+/*
+ * Hint types of ACStemHint.
+ */
+enum
+{
+    AC_HStem,
+    AC_VStem,
+    AC_HStem3,
+    AC_VStem3
+};
+
+/*
+ * A hint of a hinting result: the bottom (horizontal stems) or left (vertical
+ * stems) edge of the stem and its width, in 24.8 fixed point, and the
+ * indexes in the path of the elements the hint was made for (-1 if none), as
+ * needed when hinting multiple masters.
+ */
+typedef struct
+{
+    int type;
+    int32_t edge, width;
+    int32_t elements[2];
+} ACStemHint;
+
+/*
+ * A set of hints of a hinting result: the count hints starting at
+ * hints[first], in effect from the path element with the index element on.
+ */
+typedef struct
+{
+    size_t element;
+    size_t first, count;
+} ACHintSet;
+
+/*
+ * The hinted glyph in structured form: the glyph name, all the hints of the
+ * hint sets (ordered like in bez data), the hint sets (the first one for the
+ * start of the path, the next ones for hint substitution) and the possibly
+ * edited path. A glyph without hints has no hint sets. The capacities are
+ * for the library only.
+ */
+typedef struct
+{
+    char glyphName[64];
+    ACStemHint* hints;
+    size_t hintCount, hintCapacity;
+    ACHintSet* hintSets;
+    size_t hintSetCount, hintSetCapacity;
+    ACPathElement* path;
+    size_t pathLength, pathCapacity;
+} ACHintResult;
+
+/*
+ * Function: ACHintResultNew
+ *
+ * Returns a new, empty hinting result, or NULL if it fails.
+ */
+ACLIB_API ACHintResult* ACHintResultNew(void);
+
+/*
+ * Function: ACHintResultFree
+ *
+ * Frees a hinting result created with ACHintResultNew().
+ */
+ACLIB_API void ACHintResultFree(ACHintResult* result);
+
+/*
+ * Function: ACContextSetHintResult
+ *
+ * Makes the next glyphs hinted with ctx also be written to result (replacing
+ * its contents each time) until it is set to NULL again. The output buffer
+ * of the hinting functions may then be NULL, to skip writing bez data.
+ */
+ACLIB_API void ACContextSetHintResult(ACContext* ctx, ACHintResult* result);
+
+/*
+ * Where the time of a call went, see ACContextSetStats(): the times, in
+ * nanoseconds, of the phases of the hinting (added up over all the passes
+ * over the glyph), and some counts for the whole call.
+ */
+typedef struct
+{
+    char glyphName[64];
+    uint64_t readGlyphNs, preGenPtsNs, genHPtsNs, genVPtsNs, evalHNs,
+      evalVNs, pruneHValsNs, pruneVValsNs, mergeValsNs, autoExtraHintsNs,
+      shuffleSubpathsNs, saveFileNs;
+    size_t segments;        /* hint segments generated */
+    size_t candidateValues; /* stem candidates evaluated */
+    size_t prunedValues;    /* candidates pruned */
+    size_t hintSets;        /* hint sets written */
+    size_t retries;         /* hinting passes after the first one */
+    size_t arenaBytes;      /* most hinting memory in use at once */
+} ACStats;
+
+/*
+ * Function: ACContextSetStats
+ *
+ * Makes the next glyphs hinted with ctx fill in stats (clearing it at the
+ * start of each call) until it is set to NULL again. Without stats, the
+ * phases are not timed at all.
+ */
+ACLIB_API void ACContextSetStats(ACContext* ctx, ACStats* stats);
+
+/*
+ * Function: ACContextSetAnalyticBBox
+ *
+ * If analytic is non-zero, the bounding boxes of the curves of the glyphs
+ * hinted with ctx come from the exact extrema of the curves instead of from
+ * flattening them. This is faster, but a box can then be one unit larger
+ * than before after rounding, which may change the hints. Off by default.
+ */
+ACLIB_API void ACContextSetAnalyticBBox(ACContext* ctx, int analytic);
+
+/*
+ * Function: AutoHintBatch
+ *
+ * Hints the n glyphs in glyphs (null terminated bez strings, as for
+ * AutoHintString()) using the font info info, writing the hinted glyph i to
+ * out[i] and its result code (AC_Success etc.) to status[i]. A glyph that
+ * fails to hint does not stop the rest of the batch.
+ *
+ * The glyphs are hinted on nthreads threads (including the calling one), each
+ * with its own context; if nthreads is less than 1, one thread per processor
+ * is used. Idle threads take over glyphs from busy ones, so the threads stay
+ * busy even if some glyphs take much longer than others. The contexts of the
+ * threads get the process-wide callbacks set with the AC_Set*CB functions,
+ * which may then be called from any of the threads at the same time.
+ *
+ * Returns AC_Success if the batch was run, even if some glyphs failed.
+ */
+ACLIB_API int AutoHintBatch(const char** glyphs, size_t n,
+                            const ACFontInfo* info, ACBuffer** out,
+                            int* status, int nthreads, int allowEdit,
+                            int allowHintSub, int roundCoords);
+
 /*
  * Function: AC_initCallGlobals
  *
  * This function must be called in the case where the program is switching
- * between any of the auto-hinting and stem reporting modes while running.
+ * between any of the auto-hinting and stem reporting modes while running. It
+ * clears the process-wide callbacks; contexts created before keep theirs.
  */
 ACLIB_API void AC_initCallGlobals(void);
 
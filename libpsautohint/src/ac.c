@@ -12,62 +12,135 @@
 
 #define MAXSTEMDIST 150 /* initial maximum stem width allowed for hints */
 
-PathElt *gPathStart, *gPathEnd;
-bool gUseV, gUseH, gAutoLinearCurveFix, gEditGlyph;
-bool gHasFlex, gFlexOK, gFlexStrict, gBandError;
-Fixed gHBigDist, gVBigDist, gInitBigDist, gMinDist, gGhostWidth, gGhostLength,
-  gBendLength, gBandMargin, gMaxFlare, gMaxBendMerge, gMaxMerge,
-  gMinHintElementLength, gFlexCand;
-Fixed gPruneA, gPruneB, gPruneC, gPruneD, gPruneValue, gBonus;
-float gTheta, gHBigDistR, gVBigDistR, gMaxVal, gMinVal;
-int32_t gLenTopBands, gLenBotBands, gNumSerifs, gDMin, gDelta, gCPpercent;
-int32_t gBendTan, gSCurveTan;
-HintVal *gVHinting, *gHHinting, *gVPrimary, *gHPrimary, *gValList;
-HintSeg* gSegLists[4];
-Fixed gVStems[MAXSTEMS], gHStems[MAXSTEMS];
-int32_t gNumVStems, gNumHStems;
-Fixed gTopBands[MAXBLUES], gBotBands[MAXBLUES], gSerifs[MAXSERIFS];
-HintPoint *gPointList, **gPtLstArray;
-int32_t gPtLstIndex, gNumPtLsts, gMaxPtLsts;
+AC_THREAD_LOCAL ACContext* gContext = NULL;
+ACCallbacks gDefaultCallbacks = { .logLevel = AC_LogDebug };
+
 bool gWriteHintedBez = true;
-Fixed gBlueFuzz;
-bool gDoAligns = false, gDoStems = false;
-bool gRoundToInt;
 static int maxStemDist = MAXSTEMDIST;
 
-/* if false, then stems defined by curves are excluded from the reporting */
-unsigned int gAllStems = false;
-AC_REPORTSTEMPTR gAddHStemCB = NULL;
-AC_REPORTSTEMPTR gAddVStemCB = NULL;
-AC_REPORTZONEPTR gAddGlyphExtremesCB = NULL;
-AC_REPORTZONEPTR gAddStemExtremesCB = NULL;
-AC_RETRYPTR gReportRetryCB = NULL;
-void* gAddStemUserData = NULL;
-void* gAddExtremesUserData = NULL;
-void* gReportRetryUserData = NULL;
+#define VMCHUNKSIZE (128 * 1024) /* default size of the sub allocator chunks */
 
-#define VMSIZE (1000000)
-static unsigned char *vmfree, *vmlast, vm[VMSIZE];
+#define vmChunks (gContext->vmChunks)
+#define vmChunk (gContext->vmChunk)
+#define vmfree (gContext->vmfree)
+#define vmlast (gContext->vmlast)
 
 /* sub allocator */
+
+/*
+ * Alloc() hands out zeroed memory from a list of chunks that grows as needed
+ * and is kept from one glyph to the next. Only the chunks up to vmChunk have
+ * been used since the last reset, and each of them remembers how much of it
+ * was handed out, so a reset only needs to zero that much.
+ */
+typedef struct _t_vmchunk {
+    struct _t_vmchunk* next;
+    size_t size; /* size of data */
+    size_t used; /* high-water mark of data, once the chunk is left */
+    unsigned char data[];
+} VMChunk;
+
+/* Makes a chunk of at least sz bytes the current one. */
+static void
+NextVMChunk(size_t sz)
+{
+    VMChunk* chunk;
+    VMChunk** link;
+
+    if (vmChunk != NULL) {
+        vmChunk->used = (size_t)(vmfree - vmChunk->data);
+        link = &vmChunk->next;
+    } else {
+        link = &vmChunks;
+    }
+
+    chunk = *link;
+    if (chunk == NULL || chunk->size < sz) {
+        size_t size = sz > VMCHUNKSIZE ? sz : VMCHUNKSIZE;
+        chunk = (VMChunk*)AllocateMem(1, sizeof(VMChunk) + size,
+                                      "hinting memory");
+        chunk->size = size;
+        chunk->next = *link;
+        *link = chunk;
+    }
+
+    vmChunk = chunk;
+    vmfree = chunk->data;
+    vmlast = chunk->data + chunk->size;
+}
+
 void*
 Alloc(int32_t sz)
 {
     unsigned char* s;
-    sz = (sz + 3) & ~3; /* make size a multiple of 4 */
+    sz = (sz + 7) & ~7; /* make size a multiple of 8 */
+    if (vmChunk == NULL || (size_t)sz > (size_t)(vmlast - vmfree))
+        NextVMChunk((size_t)sz);
     s = vmfree;
     vmfree += sz;
-    if (vmfree > vmlast) /* Error! need to make VMSIZE bigger */
-    {
-        LogMsg(LOGERROR, FATALERROR, "Exceeded VM size for hints.");
+    return s;
+}
+
+#define POOLBLOCK 64 /* records carved from the arena at a time */
+
+void*
+PoolAlloc(RecPool* pool, int32_t sz)
+{
+    unsigned char* s;
+    sz = (sz + 7) & ~7;
+    if (pool->next == NULL || sz > pool->end - pool->next) {
+        pool->next = (unsigned char*)Alloc(sz * POOLBLOCK);
+        pool->end = pool->next + sz * POOLBLOCK;
     }
+    s = pool->next;
+    pool->next += sz;
     return s;
 }
 
+/* Zeroes what was handed out since the last reset and starts over. Returns
+ * how many bytes that was. */
+static size_t
+ResetVM(void)
+{
+    VMChunk* chunk;
+    VMChunk* last = vmChunk;
+    size_t used = 0;
+
+    memset(&gContext->pools, 0, sizeof(gContext->pools));
+    if (last == NULL)
+        return 0;
+
+    last->used = (size_t)(vmfree - last->data);
+    for (chunk = vmChunks; chunk != last->next; chunk = chunk->next) {
+        memset(chunk->data, 0x0, chunk->used);
+        used += chunk->used;
+        chunk->used = 0;
+    }
+
+    vmChunk = vmChunks;
+    vmfree = vmChunk->data;
+    vmlast = vmChunk->data + vmChunk->size;
+    return used;
+}
+
+void
+FreeVM(void)
+{
+    while (vmChunks != NULL) {
+        VMChunk* next = vmChunks->next;
+        UnallocateMem(vmChunks);
+        vmChunks = next;
+    }
+    vmChunk = NULL;
+    vmfree = vmlast = NULL;
+    memset(&gContext->pools, 0, sizeof(gContext->pools));
+}
+
 void
 InitData(int32_t reason)
 {
     float tmp;
+    size_t used;
 
     gGlyphName[0] = '\0';
 
@@ -111,9 +184,11 @@ InitData(int32_t reason)
             gBlueFuzz = DEFAULTBLUEFUZZ;
         /* fall through */
         case RESTART:
-            memset((void*)vm, 0x0, VMSIZE);
-            vmfree = vm;
-            vmlast = vm + VMSIZE;
+            /* a restart ends a pass over the glyph; the reset at the
+             * start of a call may still hold what a failed call left */
+            used = ResetVM();
+            if (reason == RESTART && gStats && used > gStats->arenaBytes)
+                gStats->arenaBytes = used;
 
             /* ?? Does this cause a leak ?? */
             gPointList = NULL;
@@ -133,7 +208,7 @@ InitData(int32_t reason)
 
 /* Returns whether hinting was successful. */
 bool
-AutoHint(const ACFontInfo* fontinfo, const char* srcbezdata, bool extrahint,
+AutoHint(const ACFontInfo* fontinfo, const GlyphSource* glyph, bool extrahint,
          bool changeGlyph, bool roundCoords)
 {
     InitAll(STARTUP);
@@ -145,5 +220,5 @@ AutoHint(const ACFontInfo* fontinfo, const char* srcbezdata, bool extrahint,
     gRoundToInt = roundCoords;
     gAutoLinearCurveFix = gEditGlyph;
 
-    return AutoHintGlyph(srcbezdata, extrahint);
+    return AutoHintGlyph(glyph, extrahint);
 }
@@ -52,14 +52,33 @@ typedef struct {
    Fixed x, y;
    } Cd;
 
+/* the glyph to hint, either bez data or a path */
 typedef struct {
-  int16_t limit;
-  Fixed feps;
-  void (*report)(Cd);
-  Cd ll, ur;
-  Fixed llx, lly;
+  const char* bez;          /* NULL if the glyph is a path */
+  const char* name;
+  const ACPathElement* path;
+  size_t pathLength;
+} GlyphSource;
+
+#define FLTNBUFLEN 64
+
+typedef struct {
+  void (*report)(const Cd* pts, int32_t cnt);
+    /* gets the points of a flattened curve in order, a batch at a time */
+  Cd pts[FLTNBUFLEN];
+  int32_t cnt;
   } FltnRec;
 
+/* Records of one kind are handed out by PoolAlloc() from blocks of the arena
+ * of their own, so that the segment, value and link lists that are scanned
+ * over and over end up mostly contiguous instead of interleaved with
+ * everything else. */
+typedef struct {
+  unsigned char *next, *end;
+  } RecPool;
+
+/* The fields that the evaluation loops scan come first in HintSeg, HintVal
+ * and PathElt, so that they share a cache line. */
 typedef struct _hintseg {
   struct _hintseg *sNxt;
     /* points to next HintSeg in list */
@@ -68,6 +87,8 @@ typedef struct _hintseg {
     /* sLoc is X loc for vertical seg, Y loc for horizontal seg */
     /* sMax and sMin give Y extent for vertical seg, X extent for horizontal */
     /* i.e., sTop=sMax, sBot=sMin, sLft=sMin, sRght=sMax. */
+  int16_t sType;
+    /* tells what type of segment this is: sLINE sBEND sCURVE or sGHOST */
   Fixed sBonus;
     /* nonzero for segments in sol-eol subpaths */
     /* (probably a leftover that is no longer needed) */
@@ -77,8 +98,6 @@ typedef struct _hintseg {
   struct _pthelt *sElt;
     /* points to the path element that generated this HintSeg */
     /* set by AddSegment in gen.c */
-  int16_t sType;
-    /* tells what type of segment this is: sLINE sBEND sCURVE or sGHOST */
   } HintSeg;
 
 typedef struct {
@@ -111,17 +130,17 @@ typedef struct _hintval {
 typedef struct _hintval {
   struct _hintval *vNxt;
     /* points to next HintVal in list */
+  Fixed vLoc1, vLoc2;
+    /* vLoc1 is location corresponding to vSeg1 */
+    /* vLoc2 is location corresponding to vSeg2 */
+    /* for horizontal HintVal, vBot=vLoc1 and vTop=vLoc2 */
+    /* for vertical HintVal, vLft=vLoc1 and vRght=vLoc2 */
   Fixed vVal, vSpc, initVal;
     /* vVal is value given in eval.c */
     /* vSpc is nonzero for "special" HintVals */
        /* such as those with a segment in a blue zone */
     /* initVal is the initially assigned value */
        /* used by FndBstVal in pick.c */
-  Fixed vLoc1, vLoc2;
-    /* vLoc1 is location corresponding to vSeg1 */
-    /* vLoc2 is location corresponding to vSeg2 */
-    /* for horizontal HintVal, vBot=vLoc1 and vTop=vLoc2 */
-    /* for vertical HintVal, vLft=vLoc1 and vRght=vLoc2 */
   unsigned int vGhst:1;  /* true iff one of the HintSegs is a sGHOST seg */
   unsigned int pruned:1;
     /* flag used by FindBestHVals and FindBestVVals */ 
@@ -138,13 +157,13 @@ typedef struct _hintval {
 #endif
 
 typedef struct _pthelt {
-  struct _pthelt *prev, *next, *conflict;
+  struct _pthelt *prev, *next;
+  Fixed x, y, x1, y1, x2, y2, x3, y3;
   int16_t type;
-  SegLnkLst *Hs, *Vs;
-  bool Hcopy:1, Vcopy:1, isFlex:1, yFlex:1, newCP:1;
-  unsigned int unused:9;
   int16_t count, newhints;
-  Fixed x, y, x1, y1, x2, y2, x3, y3;
+  bool Hcopy:1, Vcopy:1, isFlex:1, yFlex:1, newCP:1;
+  struct _pthelt *conflict;
+  SegLnkLst *Hs, *Vs;
   } PathElt;
 
 typedef struct _hintpnt {
@@ -160,75 +179,333 @@ typedef struct _hintpnt {
   } HintPoint;
 
 typedef struct {
-  char** keys;      /* font information keys */
-  char** values;    /* font information values */
-  size_t length;    /* number of the entries */
-} ACFontInfo;
+  int32_t cnt;
+    /* number of subpaths */
+  PathElt **starts;
+    /* the moveto of each subpath */
+  int32_t *pairs, numPairs, maxPairs;
+    /* linked subpaths as i j pairs with i < j, possibly repeated */
+  } SubpathLinks;
 
-/* global data */
+#define MAXFLEX (PSDist(20))
+#define MAXBLUES (20)
+#define MAXSERIFS (5)
+#define MAXSTEMS (20)
+#define MAX_GLYPHNAME_LEN 64
+#define STKMAX (20)
+#define MAXBUFFLEN 127
+#define HINTMAXSTR 2048
 
-extern ACBuffer* gBezOutput;
+/* classes of the glyph names with special handling, see charprop.c */
+#define VCOUNTERGLYPH 0x01
+#define HCOUNTERGLYPH 0x02
+#define UPPERSPECIALGLYPH 0x04
+#define LOWERSPECIALGLYPH 0x08
+#define NOBLUEGLYPH 0x10
 
-extern PathElt* gPathStart, *gPathEnd;
-extern bool gUseV, gUseH, gAutoLinearCurveFix;
-extern bool gEditGlyph; /* whether glyph can be modified when adding hints */
-extern bool gBandError;
-extern bool gHasFlex, gFlexOK, gFlexStrict;
-extern Fixed gHBigDist, gVBigDist, gInitBigDist, gMinDist, gGhostWidth,
-  gGhostLength, gBendLength, gBandMargin, gMaxFlare,
-  gMaxBendMerge, gMaxMerge, gMinHintElementLength, gFlexCand;
-extern Fixed gPruneA, gPruneB, gPruneC, gPruneD, gPruneValue, gBonus;
-extern float gTheta, gHBigDistR, gVBigDistR, gMaxVal, gMinVal;
-extern int32_t gDMin, gDelta, gCPpercent, gBendTan, gSCurveTan;
-extern HintVal *gVHinting, *gHHinting, *gVPrimary, *gHPrimary, *gValList;
-extern HintSeg* gSegLists[4]; /* left, right, top, bot */
-extern HintPoint* gPointList, **gPtLstArray;
-extern int32_t gPtLstIndex, gNumPtLsts, gMaxPtLsts;
+typedef struct {
+  char* name;           /* NULL for an empty slot */
+  unsigned int classes;
+} GlyphNameEntry;
 
-/* global callbacks */
+typedef struct {
+  GlyphNameEntry* entries;
+  size_t size;          /* number of slots, a power of two */
+  size_t count;         /* number of names */
+} GlyphNameSet;
 
-/* if false, then stems defined by curves are excluded from the reporting */
-extern unsigned int gAllStems;
+struct ACFontInfo {
+  char** keys;      /* font information keys */
+  char** values;    /* font information values */
+  size_t length;    /* number of the entries */
 
-extern AC_REPORTSTEMPTR gAddHStemCB;
-extern AC_REPORTSTEMPTR gAddVStemCB;
+  /* decoded once by ParseFontInfo() for ReadFontInfo() */
+  bool stemsOK;     /* false if the stems have to be decoded (and the error
+                       reported) while hinting */
+  Fixed hStems[MAXSTEMS], vStems[MAXSTEMS];
+  int32_t numHStems, numVStems;
+  bool flexOK, flexStrict;
+  Fixed blueFuzz;
+  Fixed topBands[MAXBLUES], botBands[MAXBLUES];
+  int32_t lenTopBands, lenBotBands;
+  GlyphNameSet glyphNames;
+};
+
+#if defined(_MSC_VER)
+#define AC_THREAD_LOCAL __declspec(thread)
+#else
+#define AC_THREAD_LOCAL __thread
+#endif
 
-extern AC_REPORTZONEPTR gAddGlyphExtremesCB;
-extern AC_REPORTZONEPTR gAddStemExtremesCB;
+/* callbacks */
 
-extern AC_RETRYPTR gReportRetryCB;
+/*
+ * The callbacks (and the reporting mode that goes with them) are kept in each
+ * context, so that threads hinting with different contexts can report to
+ * their own buffers. The AC_Set*CB functions set the process-wide defaults in
+ * gDefaultCallbacks, which new contexts start with and which the default
+ * context of AutoHintString() follows on every call.
+ */
+typedef struct {
+    AC_REPORTFUNCPTR report;
+    AC_REPORTSTEMPTR addHStem, addVStem;
+    AC_REPORTZONEPTR addGlyphExtremes, addStemExtremes;
+    AC_RETRYPTR reportRetry;
+    void* addStemUserData;
+    void* addExtremesUserData;
+    void* reportRetryUserData;
+    /* if false, then stems defined by curves are excluded from the reporting */
+    unsigned int allStems;
+    bool doAligns, doStems;
+    int logLevel; /* messages below this level are dropped by LogMsg() */
+} ACCallbacks;
+
+extern ACCallbacks gDefaultCallbacks;
+
+/* those of the current context, or the defaults outside of a call */
+#define gCallbacks                                                             \
+    (*(gContext != NULL ? &gContext->callbacks : &gDefaultCallbacks))
+
+#define gLibReportCB (gCallbacks.report)
+#define gAddHStemCB (gCallbacks.addHStem)
+#define gAddVStemCB (gCallbacks.addVStem)
+#define gAddGlyphExtremesCB (gCallbacks.addGlyphExtremes)
+#define gAddStemExtremesCB (gCallbacks.addStemExtremes)
+#define gReportRetryCB (gCallbacks.reportRetry)
+#define gAddStemUserData (gCallbacks.addStemUserData)
+#define gAddExtremesUserData (gCallbacks.addExtremesUserData)
+#define gReportRetryUserData (gCallbacks.reportRetryUserData)
+#define gAllStems (gCallbacks.allStems)
+#define gDoAligns (gCallbacks.doAligns)
+#define gDoStems (gCallbacks.doStems)
+#define gLogLevel (gCallbacks.logLevel)
+
+/* Whether LogMsg() would report a message of the given level. Reports that
+ * only log debug messages are wrapped in DebugReport() so that they cost a
+ * branch when nobody listens. */
+#define LogEnabled(level) (gLibReportCB != NULL && (level) >= gLogLevel)
+#define DebugReport(call)                                                      \
+    do {                                                                       \
+        if (LogEnabled(LOGDEBUG))                                              \
+            call;                                                              \
+    } while (0)
 
-extern void* gAddStemUserData;
-extern void* gAddExtremesUserData;
-extern void* gReportRetryUserData;
+extern bool gWriteHintedBez;
 
 void AddStemExtremes(Fixed bot, Fixed top);
 
+/* hinting state */
+
+/*
+ * Everything that used to be kept in process globals and file statics while
+ * hinting a glyph lives in an ACContext, so that different threads can hint
+ * glyphs at the same time, each with its own context. The context being
+ * worked on is gContext, which is thread-local and is set by the entry points
+ * in psautohint.c for the duration of a call. The g* names below are kept as
+ * macros so that the hinting code can keep using them as before; the statics
+ * of the individual source files are mapped the same way at the top of each
+ * file.
+ */
+struct ACContext {
+    ACCallbacks callbacks;
+    /* ac.c */
+    struct _t_vmchunk *vmChunks, *vmChunk; /* sub allocator arena */
+    unsigned char *vmfree, *vmlast;
+    struct {
+        RecPool segs, vals, lnks, lnkLsts;
+    } pools; /* emptied along with the arena */
+    PathElt *pathStart, *pathEnd;
+    bool useV, useH, autoLinearCurveFix;
+    bool editGlyph; /* whether glyph can be modified when adding hints */
+    bool bandError;
+    bool hasFlex, flexOK, flexStrict;
+    Fixed hBigDist, vBigDist, initBigDist, minDist, ghostWidth, ghostLength,
+      bendLength, bandMargin, maxFlare, maxBendMerge, maxMerge,
+      minHintElementLength, flexCand;
+    Fixed pruneA, pruneB, pruneC, pruneD, pruneValue, bonus;
+    float theta, hBigDistR, vBigDistR, maxVal, minVal;
+    int32_t dMin, delta, cpPercent, bendTan, sCurveTan;
+    HintVal *vHinting, *hHinting, *vPrimary, *hPrimary, *valList;
+    HintSeg* segLists[4]; /* left, right, top, bot */
+    HintPoint *pointList, **ptLstArray;
+    int32_t ptLstIndex, numPtLsts, maxPtLsts;
+    Fixed topBands[MAXBLUES], botBands[MAXBLUES], serifs[MAXSERIFS];
+    int32_t lenTopBands, lenBotBands, numSerifs;
+    Fixed vStems[MAXSTEMS], hStems[MAXSTEMS];
+    int32_t numVStems, numHStems;
+    Fixed blueFuzz;
+    bool roundToInt;
+
+    /* psautohint.c and logging.c */
+    ACBuffer* bezOutput;
+    ACHintResult* hintResult;    /* structured output, if wanted */
+    ACStats* stats;              /* timings and counts, if wanted */
+    jmp_buf* errorMark;          /* error recovery point of the current call */
+    int (*errorproc)(int16_t);   /* called from LogMsg() if an error occurs */
+
+    /* read.c */
+    char glyphName[MAX_GLYPHNAME_LEN];
+    struct {
+        Fixed currentx, currenty, tempx, tempy;
+        Fixed stk[STKMAX];
+        int32_t stkindex;
+        bool flex, startchar;
+        bool forMultiMaster, includeHints;
+    } read;
+
+    /* write.c */
+    struct {
+        Fixed currentx, currenty;
+        bool firstFlex, wrtHintInfo;
+        char S0[MAXBUFFLEN + 1];
+        char hintmaskstr[HINTMAXSTR];
+        char prevhintmaskstr[HINTMAXSTR];
+        size_t hintmasklen, prevhintmasklen;
+        int32_t prevPtLst;        /* list of the hints in prevhintmaskstr */
+        HintPoint*** sortedLsts;  /* the point lists in writing order */
+        int32_t* sortedCnts;
+        Fixed flX, flY;
+        Cd fc1, fc2, fc3;
+    } write;
+
+    /* fontinfo.c and charprop.c, the set belongs to the font info */
+    const GlyphNameSet* glyphNames;
+
+    /* charpath.c and charpathpriv.c */
+    int32_t pathEntries; /* number of elements in a glyph path */
+    bool addHints;       /* whether to include hints in the font */
+    struct {
+        bool firstMT;
+        Cd* refPtArray;
+        ACBuffer* outbuff;
+        int masterCount;
+        const char** masterNames;
+        struct _t_pathlist* pathlist;
+        indx hintsMasterIx; /* The index of the master we read hints from */
+        int32_t maxPathEntries;
+        struct _t_pathlist* currPathList;
+    } charpath;
+
+    /* bbox.c */
+    struct {
+        Fixed xmin, ymin, xmax, ymax, vMn, vMx, hMn, hMx;
+        PathElt *pxmn, *pxmx, *pymn, *pymx, *pe, *pvMn, *pvMx, *phMn, *phMx;
+        bool analytic; /* curve extrema solved instead of flattened */
+    } bbox;
+
+    /* check.c */
+    struct {
+        bool g_xflat, g_yflat, g_xdone, g_ydone, g_bbquit;
+        int32_t g_xstate, g_ystate, g_xstart, g_ystart;
+        Fixed g_x0, g_cy0, g_x1, g_cy1, g_xloc, g_yloc;
+        Fixed g_x, g_y, g_xnxt, g_ynxt;
+        Fixed g_yflatstartx, g_yflatstarty, g_yflatendx, g_yflatendy;
+        Fixed g_xflatstarty, g_xflatstartx, g_xflatendx, g_xflatendy;
+        bool g_vert, g_started, g_reCheckSmooth;
+        Fixed g_loc, g_frst, g_lst, g_fltnvalue;
+        PathElt* g_e;
+        bool g_forMultiMaster, g_inflPtFound;
+    } check;
+
+    /* auto.c */
+    bool mergeMain;
+
+    /* control.c */
+    bool counterFailed;
+    struct {
+        PathElt* elts; /* the set up path in order, kept out of the arena */
+        int32_t len, max;
+        char glyphName[MAX_GLYPHNAME_LEN];
+    } pathSnap;
+
+    /* fix.c */
+    Fixed bPrev, tPrev;
+
+    /* gen.c */
+    SegLnkLst *hlnks, *vlnks;
+    int32_t cpFrom, cpTo;
+
+    /* pick.c */
+    HintVal *vrejects, *hrejects;
+};
+
+extern AC_THREAD_LOCAL ACContext* gContext;
+
+#define gBezOutput (gContext->bezOutput)
+#define gHintResult (gContext->hintResult)
+#define gStats (gContext->stats)
+#define gPathStart (gContext->pathStart)
+#define gPathEnd (gContext->pathEnd)
+#define gUseV (gContext->useV)
+#define gUseH (gContext->useH)
+#define gAutoLinearCurveFix (gContext->autoLinearCurveFix)
+#define gEditGlyph (gContext->editGlyph)
+#define gBandError (gContext->bandError)
+#define gHasFlex (gContext->hasFlex)
+#define gFlexOK (gContext->flexOK)
+#define gFlexStrict (gContext->flexStrict)
+#define gHBigDist (gContext->hBigDist)
+#define gVBigDist (gContext->vBigDist)
+#define gInitBigDist (gContext->initBigDist)
+#define gMinDist (gContext->minDist)
+#define gGhostWidth (gContext->ghostWidth)
+#define gGhostLength (gContext->ghostLength)
+#define gBendLength (gContext->bendLength)
+#define gBandMargin (gContext->bandMargin)
+#define gMaxFlare (gContext->maxFlare)
+#define gMaxBendMerge (gContext->maxBendMerge)
+#define gMaxMerge (gContext->maxMerge)
+#define gMinHintElementLength (gContext->minHintElementLength)
+#define gFlexCand (gContext->flexCand)
+#define gPruneA (gContext->pruneA)
+#define gPruneB (gContext->pruneB)
+#define gPruneC (gContext->pruneC)
+#define gPruneD (gContext->pruneD)
+#define gPruneValue (gContext->pruneValue)
+#define gBonus (gContext->bonus)
+#define gTheta (gContext->theta)
+#define gHBigDistR (gContext->hBigDistR)
+#define gVBigDistR (gContext->vBigDistR)
+#define gMaxVal (gContext->maxVal)
+#define gMinVal (gContext->minVal)
+#define gDMin (gContext->dMin)
+#define gDelta (gContext->delta)
+#define gCPpercent (gContext->cpPercent)
+#define gBendTan (gContext->bendTan)
+#define gSCurveTan (gContext->sCurveTan)
+#define gVHinting (gContext->vHinting)
+#define gHHinting (gContext->hHinting)
+#define gVPrimary (gContext->vPrimary)
+#define gHPrimary (gContext->hPrimary)
+#define gValList (gContext->valList)
+#define gSegLists (gContext->segLists)
+#define gPointList (gContext->pointList)
+#define gPtLstArray (gContext->ptLstArray)
+#define gPtLstIndex (gContext->ptLstIndex)
+#define gNumPtLsts (gContext->numPtLsts)
+#define gMaxPtLsts (gContext->maxPtLsts)
+#define gTopBands (gContext->topBands)
+#define gBotBands (gContext->botBands)
+#define gSerifs (gContext->serifs)
+#define gLenTopBands (gContext->lenTopBands)
+#define gLenBotBands (gContext->lenBotBands)
+#define gNumSerifs (gContext->numSerifs)
+#define gVStems (gContext->vStems)
+#define gHStems (gContext->hStems)
+#define gNumVStems (gContext->numVStems)
+#define gNumHStems (gContext->numHStems)
+#define gGlyphNames (gContext->glyphNames)
+#define gBlueFuzz (gContext->blueFuzz)
+#define gRoundToInt (gContext->roundToInt)
+#define gAddHints (gContext->addHints)
+/* set from the glyph name at the start of the bez file, see read.c. */
+#define gGlyphName (gContext->glyphName)
+
 #define leftList (gSegLists[0])
 #define rightList (gSegLists[1])
 #define topList (gSegLists[2])
 #define botList (gSegLists[3])
 
-#define MAXFLEX (PSDist(20))
-#define MAXBLUES (20)
-#define MAXSERIFS (5)
-extern Fixed gTopBands[MAXBLUES], gBotBands[MAXBLUES], gSerifs[MAXSERIFS];
-extern int32_t gLenTopBands, gLenBotBands, gNumSerifs;
-#define MAXSTEMS (20)
-extern Fixed gVStems[MAXSTEMS], gHStems[MAXSTEMS];
-extern int32_t gNumVStems, gNumHStems;
-extern char *gHHintList[], *gVHintList[];
-extern int32_t gNumHHints, gNumVHints;
-extern bool gWriteHintedBez;
-extern Fixed gBlueFuzz;
-extern bool gDoAligns, gDoStems;
-extern bool gRoundToInt;
-extern bool gAddHints;
-
-#define MAX_GLYPHNAME_LEN 64
-/* defined in read.c; set from the glyph name at the start of the bex file. */
-extern char gGlyphName[MAX_GLYPHNAME_LEN];
-
 /* macros */
 
 #define FixOne (0x100)
@@ -241,6 +518,8 @@ extern char gGlyphName[MAX_GLYPHNAME_LEN];
 #define FixInt(i) (((int32_t)(i)) * FixOne)
 #define FixReal(i) ((int32_t)((i) * (float)FixOne))
 int32_t FRnd(int32_t x);
+void BufferWriteInt(ACBuffer* buffer, int32_t value);
+void BufferWriteFixed(ACBuffer* buffer, Fixed value);
 #define FHalfRnd(x) ((int32_t)(((x)+(1<<7)) & ~0xFF))
 #define FracPart(x) ((int32_t)(x) & 0xFF)
 #define FTrunc(x) (((int32_t)(x)) / FixOne)
@@ -268,9 +547,38 @@ void acfixtopflt(Fixed x, float* pf);
 Fixed acpflttofix(float* pf);
 
 void *Alloc(int32_t sz); /* Sub-allocator */
-
-int AddCounterHintGlyphs(char* charlist, char* HintList[]);
-bool FindNameInList(char* nm, char** lst);
+void *PoolAlloc(RecPool* pool, int32_t sz);
+void FreeVM(void);
+
+#define NewHintSeg() ((HintSeg*)PoolAlloc(&gContext->pools.segs, sizeof(HintSeg)))
+#define NewHintVal() ((HintVal*)PoolAlloc(&gContext->pools.vals, sizeof(HintVal)))
+#define NewSegLnk() ((SegLnk*)PoolAlloc(&gContext->pools.lnks, sizeof(SegLnk)))
+#define NewSegLnkLst()                                                         \
+    ((SegLnkLst*)PoolAlloc(&gContext->pools.lnkLsts, sizeof(SegLnkLst)))
+
+/* For ACContextSetStats(): call is timed and counts are added to only if
+ * the caller asked for them. */
+uint64_t NanoTime(void);
+#define TimePhase(field, call)                                                 \
+    do {                                                                       \
+        if (gStats != NULL) {                                                  \
+            uint64_t start_ = NanoTime();                                      \
+            call;                                                              \
+            gStats->field += NanoTime() - start_;                              \
+        } else {                                                               \
+            call;                                                              \
+        }                                                                      \
+    } while (0)
+#define CountStat(field, n)                                                    \
+    do {                                                                       \
+        if (gStats != NULL)                                                    \
+            gStats->field += (size_t)(n);                                      \
+    } while (0)
+
+void InitGlyphNameSet(ACFontInfo* fontinfo);
+void FreeGlyphNameSet(ACFontInfo* fontinfo);
+int AddCounterHintGlyphs(ACFontInfo* fontinfo, const char* charlist,
+                         unsigned int counterClass);
 void PruneElementHintSegs(void);
 int TestHintLst(SegLnkLst* lst, HintVal* hintList, bool flg, bool doLst);
 HintVal* CopyHints(HintVal* lst);
@@ -291,7 +599,7 @@ void AddHintPoint(Fixed x0, Fixed y0, Fixed x1, Fixed y1, char ch, PathElt* p0,
 void AddHPair(HintVal* v, char ch);
 void AddVPair(HintVal* v, char ch);
 void XtraHints(PathElt* e);
-bool AutoHintGlyph(const char* srcglyph, bool extrahint);
+bool AutoHintGlyph(const GlyphSource* glyph, bool extrahint);
 void EvalV(void);
 void EvalH(void);
 void GenVPts(int32_t specialGlyphType);
@@ -331,8 +639,8 @@ void AutoAddFlex(void);
 bool SameHints(int32_t cn1, int32_t cn2);
 bool PreCheckForHinting(void);
 int32_t CountSubPaths(void);
-void PickVVals(HintVal* gValList);
-void PickHVals(HintVal* gValList);
+void PickVVals(HintVal* valList);
+void PickHVals(HintVal* valList);
 void FindBestHVals(void);
 void FindBestVVals(void);
 void ReportAddFlex(void);
@@ -370,9 +678,9 @@ void ReportMergeVVal(Fixed l0, Fixed r0, Fixed l1, Fixed r1, Fixed v0, Fixed s0,
                      Fixed v1, Fixed s1);
 void ReportPruneHVal(HintVal* val, HintVal* v, int32_t i);
 void ReportPruneVVal(HintVal* val, HintVal* v, int32_t i);
-unsigned char* InitShuffleSubpaths(void);
-void MarkLinks(HintVal* vL, bool hFlg, unsigned char* links);
-void DoShuffleSubpaths(unsigned char* links);
+SubpathLinks* InitShuffleSubpaths(void);
+void MarkLinks(HintVal* vL, bool hFlg, SubpathLinks* links);
+void DoShuffleSubpaths(SubpathLinks* links);
 void CopyMainH(void);
 void CopyMainV(void);
 void RMovePoint(Fixed dx, Fixed dy, int32_t whichcp, PathElt* e);
@@ -382,6 +690,8 @@ void AddHSegment(Fixed from, Fixed to, Fixed loc, PathElt* p1, PathElt* p2,
                  int32_t typ, int32_t i);
 void Delete(PathElt* e);
 bool ReadGlyph(const char* srcglyph, bool forBlendData, bool readHints);
+bool ReadGlyphPath(const char* name, const ACPathElement* path,
+                   size_t length);
 double FixToDbl(Fixed f);
 bool CompareValues(HintVal* val1, HintVal* val2, int32_t factor,
                    int32_t ghstshift);
@@ -399,7 +709,7 @@ void AddHStem(Fixed top, Fixed bottom, bool curved);
 
 void AddGlyphExtremes(Fixed bot, Fixed top);
 
-bool AutoHint(const ACFontInfo* fontinfo, const char* srcbezdata,
+bool AutoHint(const ACFontInfo* fontinfo, const GlyphSource* glyph,
               bool extrahint, bool changeGlyph, bool roundCoords);
 
 bool MergeGlyphPaths(const char** srcglyphs, int nmasters,
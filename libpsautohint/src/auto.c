@@ -10,7 +10,7 @@
 #include "ac.h"
 #include "bbox.h"
 
-static bool mergeMain;
+#define mergeMain (gContext->mergeMain)
 
 static PathElt*
 GetSubPathNxt(PathElt* e)
@@ -580,7 +580,7 @@ HintsClash(PathElt* e, PathElt* p, SegLnkLst** hLst, SegLnkLst** vLst,
         clash = true;
         bst = BestFromLsts(*hLst, *phLst);
         if (bst) {
-            new = (SegLnkLst*)Alloc(sizeof(SegLnkLst));
+            new = NewSegLnkLst();
             new->next = NULL;
             new->lnk = bst->lnk;
         } else
@@ -591,7 +591,7 @@ HintsClash(PathElt* e, PathElt* p, SegLnkLst** hLst, SegLnkLst** vLst,
         clash = true;
         bst = BestFromLsts(*vLst, *pvLst);
         if (bst) {
-            new = (SegLnkLst*)Alloc(sizeof(SegLnkLst));
+            new = NewSegLnkLst();
             new->next = NULL;
             new->lnk = bst->lnk;
         } else
@@ -734,7 +734,7 @@ CopyHints(HintVal* lst)
     vlst = NULL;
     cnt = 0;
     while (lst != NULL) {
-        HintVal* v = (HintVal*)Alloc(sizeof(HintVal));
+        HintVal* v = NewHintVal();
         *v = *lst;
         v->vNxt = vlst;
         vlst = v;
@@ -916,13 +916,13 @@ CarryIfNeed(Fixed loc, bool vert, HintVal* hints)
             seg->sLnk = hints;
             if (vert) {
                 if (TestHint(seg, gVHinting, true, true) == 1) {
-                    ReportCarry(l0, l1, loc, hints, vert);
+                    DebugReport(ReportCarry(l0, l1, loc, hints, vert));
                     AddVHinting(hints);
                     seg->sLnk = seglnk;
                     break;
                 }
             } else if (TestHint(seg, gHHinting, false, true) == 1) {
-                ReportCarry(l0, l1, loc, hints, vert);
+                DebugReport(ReportCarry(l0, l1, loc, hints, vert));
                 AddHHinting(hints);
                 seg->sLnk = seglnk;
                 break;
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2014 Adobe Systems Incorporated (http://www.adobe.com/).
+ * All Rights Reserved.
+ *
+ * This software is licensed as OpenSource, under the Apache License, Version
+ * 2.0.
+ * This license is available at: http://opensource.org/licenses/Apache-2.0.
+ */
+
+/* batch.c - hints many glyphs on a pool of worker threads.
+ *
+ * Each worker owns an ACContext and a queue holding a range of glyph
+ * indexes. A worker takes glyphs from the front of its own range, and once
+ * it is empty steals the back half of the range of another worker. The time
+ * needed for a glyph varies a lot (a simple Latin glyph versus an ideograph
+ * with hundreds of subpaths), so this keeps all the workers busy until the
+ * very end of the batch, unlike a static split of the glyphs. */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "ac.h"
+
+#define MAXWORKERS 256
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION ACMutex;
+#define InitMutex(m) InitializeCriticalSection(m)
+#define DestroyMutex(m) DeleteCriticalSection(m)
+#define LockMutex(m) EnterCriticalSection(m)
+#define UnlockMutex(m) LeaveCriticalSection(m)
+#else
+typedef pthread_mutex_t ACMutex;
+#define InitMutex(m) pthread_mutex_init(m, NULL)
+#define DestroyMutex(m) pthread_mutex_destroy(m)
+#define LockMutex(m) pthread_mutex_lock(m)
+#define UnlockMutex(m) pthread_mutex_unlock(m)
+#endif
+
+typedef struct {
+    ACMutex lock;
+    size_t next, end; /* glyphs still to be hinted: [next, end) */
+} WorkQueue;
+
+typedef struct {
+    const char** glyphs;
+    const ACFontInfo* info;
+    ACBuffer** out;
+    int* status;
+    int allowEdit, allowHintSub, roundCoords;
+    WorkQueue* queues;
+    int nworkers;
+} BatchJob;
+
+typedef struct {
+    BatchJob* job;
+    ACContext* ctx;
+    int id;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    bool started;
+} Worker;
+
+static bool
+TakeGlyph(WorkQueue* queue, size_t* ix)
+{
+    bool found = false;
+
+    LockMutex(&queue->lock);
+    if (queue->next < queue->end) {
+        *ix = queue->next++;
+        found = true;
+    }
+    UnlockMutex(&queue->lock);
+
+    return found;
+}
+
+/* Moves the back half of the range of some other worker into the (empty)
+ * queue of the given worker, and takes the first glyph of it. */
+static bool
+StealGlyph(BatchJob* job, int thief, size_t* ix)
+{
+    int i;
+
+    for (i = 1; i < job->nworkers; i++) {
+        WorkQueue* victim = &job->queues[(thief + i) % job->nworkers];
+        size_t from = 0, to = 0;
+
+        LockMutex(&victim->lock);
+        if (victim->next < victim->end) {
+            to = victim->end;
+            from = to - (to - victim->next + 1) / 2;
+            victim->end = from;
+        }
+        UnlockMutex(&victim->lock);
+
+        if (from < to) {
+            WorkQueue* own = &job->queues[thief];
+            LockMutex(&own->lock);
+            own->next = from + 1;
+            own->end = to;
+            UnlockMutex(&own->lock);
+            *ix = from;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+RunWorker(Worker* worker)
+{
+    BatchJob* job = worker->job;
+    size_t ix;
+
+    while (TakeGlyph(&job->queues[worker->id], &ix) ||
+           StealGlyph(job, worker->id, &ix)) {
+        if (job->out[ix] == NULL)
+            job->status[ix] = AC_InvalidParameterError;
+        else
+            job->status[ix] = AutoHintStringWithInfo(
+              worker->ctx, job->glyphs[ix], job->info, job->out[ix],
+              job->allowEdit, job->allowHintSub, job->roundCoords);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+WorkerThread(LPVOID arg)
+{
+    RunWorker((Worker*)arg);
+    return 0;
+}
+
+static bool
+StartWorker(Worker* worker)
+{
+    worker->thread = CreateThread(NULL, 0, WorkerThread, worker, 0, NULL);
+    return worker->thread != NULL;
+}
+
+static void
+JoinWorker(Worker* worker)
+{
+    WaitForSingleObject(worker->thread, INFINITE);
+    CloseHandle(worker->thread);
+}
+
+static int
+CountProcessors(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+#else
+static void*
+WorkerThread(void* arg)
+{
+    RunWorker((Worker*)arg);
+    return NULL;
+}
+
+static bool
+StartWorker(Worker* worker)
+{
+    return pthread_create(&worker->thread, NULL, WorkerThread, worker) == 0;
+}
+
+static void
+JoinWorker(Worker* worker)
+{
+    pthread_join(worker->thread, NULL);
+}
+
+static int
+CountProcessors(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+#endif
+
+ACLIB_API int
+AutoHintBatch(const char** glyphs, size_t n, const ACFontInfo* info,
+              ACBuffer** out, int* status, int nthreads, int allowEdit,
+              int allowHintSub, int roundCoords)
+{
+    BatchJob job;
+    WorkQueue* queues;
+    Worker* workers;
+    size_t i;
+    int w, nworkers;
+
+    if (!glyphs || !info || !out || !status)
+        return AC_InvalidParameterError;
+    if (n == 0)
+        return AC_Success;
+
+    if (nthreads < 1)
+        nthreads = CountProcessors();
+    if (nthreads > MAXWORKERS)
+        nthreads = MAXWORKERS;
+    if ((size_t)nthreads > n)
+        nthreads = (int)n;
+
+    queues = (WorkQueue*)AllocateMem(nthreads, sizeof(WorkQueue), "queues");
+    workers = (Worker*)AllocateMem(nthreads, sizeof(Worker), "workers");
+    if (queues == NULL || workers == NULL) {
+        UnallocateMem(queues);
+        UnallocateMem(workers);
+        return AC_FatalError;
+    }
+
+    /* Each worker needs its own context; go with fewer workers if we can't
+     * get all of them. */
+    for (nworkers = 0; nworkers < nthreads; nworkers++) {
+        workers[nworkers].ctx = ACContextNew();
+        if (workers[nworkers].ctx == NULL)
+            break;
+    }
+    if (nworkers == 0) {
+        UnallocateMem(queues);
+        UnallocateMem(workers);
+        return AC_FatalError;
+    }
+
+    for (i = 0; i < n; i++)
+        status[i] = AC_UnknownError;
+
+    job.glyphs = glyphs;
+    job.info = info;
+    job.out = out;
+    job.status = status;
+    job.allowEdit = allowEdit;
+    job.allowHintSub = allowHintSub;
+    job.roundCoords = roundCoords;
+    job.queues = queues;
+    job.nworkers = nworkers;
+
+    /* Start with an even split, stealing takes care of the rest. */
+    for (w = 0; w < nworkers; w++) {
+        InitMutex(&queues[w].lock);
+        queues[w].next = n * w / nworkers;
+        queues[w].end = n * (w + 1) / nworkers;
+        workers[w].job = &job;
+        workers[w].id = w;
+    }
+
+    /* The calling thread is the first worker. If a thread can't be started,
+     * its glyphs are stolen by the others. */
+    for (w = 1; w < nworkers; w++)
+        workers[w].started = StartWorker(&workers[w]);
+    RunWorker(&workers[0]);
+
+    /* All the workers look at all the queues, so join them before tearing
+     * anything down. */
+    for (w = 1; w < nworkers; w++) {
+        if (workers[w].started)
+            JoinWorker(&workers[w]);
+    }
+    for (w = 0; w < nworkers; w++) {
+        ACContextFree(workers[w].ctx);
+        DestroyMutex(&queues[w].lock);
+    }
+
+    UnallocateMem(queues);
+    UnallocateMem(workers);
+
+    return AC_Success;
+}
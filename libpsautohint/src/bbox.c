@@ -10,8 +10,23 @@
 #include "bbox.h"
 #include "ac.h"
 
-static Fixed xmin, ymin, xmax, ymax, vMn, vMx, hMn, hMx;
-static PathElt *pxmn, *pxmx, *pymn, *pymx, *pe, *pvMn, *pvMx, *phMn, *phMx;
+#define xmin (gContext->bbox.xmin)
+#define ymin (gContext->bbox.ymin)
+#define xmax (gContext->bbox.xmax)
+#define ymax (gContext->bbox.ymax)
+#define vMn (gContext->bbox.vMn)
+#define vMx (gContext->bbox.vMx)
+#define hMn (gContext->bbox.hMn)
+#define hMx (gContext->bbox.hMx)
+#define pxmn (gContext->bbox.pxmn)
+#define pxmx (gContext->bbox.pxmx)
+#define pymn (gContext->bbox.pymn)
+#define pymx (gContext->bbox.pymx)
+#define pe (gContext->bbox.pe)
+#define pvMn (gContext->bbox.pvMn)
+#define pvMx (gContext->bbox.pvMx)
+#define phMn (gContext->bbox.phMn)
+#define phMx (gContext->bbox.phMx)
 
 static void
 FPBBoxPt(Cd c)
@@ -34,10 +49,149 @@ FPBBoxPt(Cd c)
     }
 }
 
+/* All points of a batch come from the path element pe, so only the batch
+ * extremes need to be compared with the box. */
+static void
+FPBBoxPts(const Cd* pts, int32_t cnt)
+{
+    Fixed mnx = pts[0].x, mxx = pts[0].x, mny = pts[0].y, mxy = pts[0].y;
+    int32_t i;
+    for (i = 1; i < cnt; i++) {
+        mnx = NUMMIN(mnx, pts[i].x);
+        mxx = NUMMAX(mxx, pts[i].x);
+        mny = NUMMIN(mny, pts[i].y);
+        mxy = NUMMAX(mxy, pts[i].y);
+    }
+    if (mnx < xmin) {
+        xmin = mnx;
+        pxmn = pe;
+    }
+    if (mxx > xmax) {
+        xmax = mxx;
+        pxmx = pe;
+    }
+    if (mny < ymin) {
+        ymin = mny;
+        pymn = pe;
+    }
+    if (mxy > ymax) {
+        ymax = mxy;
+        pymx = pe;
+    }
+}
+
+/* true if r1 and r2 are between r0 and r3, so the curve goes monotonically
+ * from r0 to r3 in this direction. */
+static bool
+InEndRange(Fixed r0, Fixed r1, Fixed r2, Fixed r3)
+{
+    Fixed lo = NUMMIN(r0, r3), hi = NUMMAX(r0, r3);
+    return r1 >= lo && r1 <= hi && r2 >= lo && r2 <= hi;
+}
+
+/* integer square root, rounded down */
+static int64_t
+ISqrt(int64_t v)
+{
+    int64_t r = 0, bit = (int64_t)1 << 62;
+    while (bit > v)
+        bit >>= 2;
+    while (bit != 0) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else
+            r >>= 1;
+        bit >>= 2;
+    }
+    return r;
+}
+
+#define TSHIFT 16
+#define TONE ((int64_t)1 << TSHIFT)
+
+/* the curve value at t (in units of 1/TONE) by de Casteljau */
+static Fixed
+BezValAt(Fixed r0, Fixed r1, Fixed r2, Fixed r3, int64_t t)
+{
+#define LERP(a, b) ((a) + ((((b) - (a)) * t + (TONE >> 1)) >> TSHIFT))
+    int64_t a = LERP((int64_t)r0, (int64_t)r1);
+    int64_t b = LERP((int64_t)r1, (int64_t)r2);
+    int64_t c = LERP((int64_t)r2, (int64_t)r3);
+    a = LERP(a, b);
+    b = LERP(b, c);
+    return (Fixed)LERP(a, b);
+#undef LERP
+}
+
+/* Narrows *mn and *mx (which start at r3) to the extremes of the curve in
+ * one direction, at the zeros of its derivative a t^2 + b t + c. */
+static void
+BezExtremes(Fixed r0, Fixed r1, Fixed r2, Fixed r3, Fixed* mn, Fixed* mx)
+{
+    int64_t a = (int64_t)r3 - r0 + 3 * ((int64_t)r1 - r2);
+    int64_t b = 2 * ((int64_t)r0 - 2 * (int64_t)r1 + r2);
+    int64_t c = (int64_t)r1 - r0;
+    int64_t num[2] = { 0, 0 }, den;
+    int i, n = 0;
+    if (a == 0) {
+        if (b == 0)
+            return;
+        num[n++] = -c;
+        den = b;
+    } else {
+        int64_t disc = b * b - 4 * a * c, s;
+        if (disc < 0)
+            return;
+        s = ISqrt(disc);
+        num[n++] = -b - s;
+        num[n++] = -b + s;
+        den = 2 * a;
+    }
+    if (den < 0) {
+        den = -den;
+        num[0] = -num[0];
+        num[1] = -num[1];
+    }
+    for (i = 0; i < n; i++) {
+        int64_t t;
+        Fixed v;
+        if (num[i] <= 0 || num[i] >= den)
+            continue;
+        t = (num[i] * TONE + (den >> 1)) / den;
+        v = BezValAt(r0, r1, r2, r3, t);
+        *mn = NUMMIN(*mn, v);
+        *mx = NUMMAX(*mx, v);
+    }
+}
+
+/* Adds the curve from c0 to the box for the path element pe. The caller has
+ * already added c0 itself. */
+static void
+FPBBoxCurve(Cd c0, Cd c1, Cd c2, Cd c3)
+{
+    if (InEndRange(c0.x, c1.x, c2.x, c3.x) &&
+        InEndRange(c0.y, c1.y, c2.y, c3.y) && c0.x >= xmin && c0.x <= xmax &&
+        c0.y >= ymin && c0.y <= ymax) {
+        /* Every flattened point is between c0 and c3, so only c3 can
+         * extend the box; this gives exactly what flattening would. */
+        FPBBoxPt(c3);
+    } else if (gContext->bbox.analytic) {
+        Cd ext[2];
+        ext[0] = ext[1] = c3;
+        BezExtremes(c0.x, c1.x, c2.x, c3.x, &ext[0].x, &ext[1].x);
+        BezExtremes(c0.y, c1.y, c2.y, c3.y, &ext[0].y, &ext[1].y);
+        FPBBoxPts(ext, 2);
+    } else {
+        FltnRec fr;
+        fr.report = FPBBoxPts;
+        FltnCurve(c0, c1, c2, c3, &fr);
+    }
+}
+
 static void
 FindPathBBox(void)
 {
-    FltnRec fr;
     PathElt* e;
     Cd c0, c1, c2, c3;
     memset(&c0, 0, sizeof(Cd));
@@ -46,7 +200,6 @@ FindPathBBox(void)
         pxmn = pxmx = pymn = pymx = NULL;
         return;
     }
-    fr.report = FPBBoxPt;
     xmin = ymin = FixInt(10000);
     xmax = ymax = -xmin;
     e = gPathStart;
@@ -67,7 +220,7 @@ FindPathBBox(void)
                 c3.x = e->x3;
                 c3.y = e->y3;
                 pe = e;
-                FltnCurve(c0, c1, c2, c3, &fr);
+                FPBBoxCurve(c0, c1, c2, c3);
                 c0 = c3;
                 break;
             case CLOSEPATH:
@@ -87,7 +240,6 @@ FindPathBBox(void)
 PathElt*
 FindSubpathBBox(PathElt* e)
 {
-    FltnRec fr;
     Cd c0, c1, c2, c3;
     memset(&c0, 0, sizeof(Cd));
     if (e == NULL) {
@@ -95,7 +247,6 @@ FindSubpathBBox(PathElt* e)
         pxmn = pxmx = pymn = pymx = NULL;
         return NULL;
     }
-    fr.report = FPBBoxPt;
     xmin = ymin = FixInt(10000);
     xmax = ymax = -xmin;
 #if 0
@@ -125,7 +276,7 @@ FindSubpathBBox(PathElt* e)
                 c3.x = e->x3;
                 c3.y = e->y3;
                 pe = e;
-                FltnCurve(c0, c1, c2, c3, &fr);
+                FPBBoxCurve(c0, c1, c2, c3);
                 c0 = c3;
                 break;
             case CLOSEPATH:
@@ -156,9 +307,7 @@ FindCurveBBox(Fixed x0, Fixed y0, Fixed px1, Fixed py1, Fixed px2, Fixed py2,
               Fixed x1, Fixed y1, Fixed* pllx, Fixed* plly, Fixed* purx,
               Fixed* pury)
 {
-    FltnRec fr;
     Cd c0, c1, c2, c3;
-    fr.report = FPBBoxPt;
     xmin = ymin = FixInt(10000);
     xmax = ymax = -xmin;
     c0.x = x0;
@@ -170,7 +319,7 @@ FindCurveBBox(Fixed x0, Fixed y0, Fixed px1, Fixed py1, Fixed px2, Fixed py2,
     c3.x = x1;
     c3.y = y1;
     FPBBoxPt(c0);
-    FltnCurve(c0, c1, c2, c3, &fr);
+    FPBBoxCurve(c0, c1, c2, c3);
     *pllx = FHalfRnd(xmin);
     *plly = FHalfRnd(ymin);
     *purx = FHalfRnd(xmax);
@@ -269,8 +418,8 @@ AddBBoxHV(bool Hflg, bool subs)
         }
         if (!Hflg) {
             if (!CheckValOverlaps(xmin, xmax, gVHinting, true)) {
-                val = (HintVal*)Alloc(sizeof(HintVal));
-                seg1 = (HintSeg*)Alloc(sizeof(HintSeg));
+                val = NewHintVal();
+                seg1 = NewHintSeg();
                 seg1->sLoc = xmin;
                 seg1->sElt = pxmn;
                 seg1->sBonus = 0;
@@ -279,7 +428,7 @@ AddBBoxHV(bool Hflg, bool subs)
                 seg1->sMax = ymax;
                 seg1->sNxt = NULL;
                 seg1->sLnk = NULL;
-                seg2 = (HintSeg*)Alloc(sizeof(HintSeg));
+                seg2 = NewHintSeg();
                 seg2->sLoc = xmax;
                 seg2->sElt = pxmx;
                 seg2->sBonus = 0;
@@ -301,8 +450,8 @@ AddBBoxHV(bool Hflg, bool subs)
             }
         } else {
             if (!CheckValOverlaps(ymin, ymax, gHHinting, false)) {
-                val = (HintVal*)Alloc(sizeof(HintVal));
-                seg1 = (HintSeg*)Alloc(sizeof(HintSeg));
+                val = NewHintVal();
+                seg1 = NewHintSeg();
                 seg1->sLoc = ymax;
                 seg1->sElt = pymx;
                 seg1->sBonus = 0;
@@ -311,7 +460,7 @@ AddBBoxHV(bool Hflg, bool subs)
                 seg1->sMax = xmax;
                 seg1->sNxt = NULL;
                 seg1->sLnk = NULL;
-                seg2 = (HintSeg*)Alloc(sizeof(HintSeg));
+                seg2 = NewHintSeg();
                 seg2->sLoc = ymin;
                 seg2->sElt = pymn;
                 seg2->sBonus = 0;
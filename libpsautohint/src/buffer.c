@@ -18,6 +18,7 @@ struct ACBuffer
     char* data;      /* buffer data, NOT null-terminated */
     size_t len;      /* actual length of the data */
     size_t capacity; /* allocated memory size */
+    bool owned;      /* false while data is the storage given to ACBufferWrap */
 };
 
 ACLIB_API ACBuffer*
@@ -33,6 +34,24 @@ ACBufferNew(size_t size)
     buffer->data[0] = '\0';
     buffer->capacity = size;
     buffer->len = 0;
+    buffer->owned = true;
+
+    return buffer;
+}
+
+ACLIB_API ACBuffer*
+ACBufferWrap(char* data, size_t size)
+{
+    ACBuffer* buffer;
+
+    if (!data || !size)
+        return NULL;
+
+    buffer = (ACBuffer*)AllocateMem(1, sizeof(ACBuffer), "buffer");
+    buffer->data = data;
+    buffer->capacity = size;
+    buffer->len = 0;
+    buffer->owned = false;
 
     return buffer;
 }
@@ -43,7 +62,8 @@ ACBufferFree(ACBuffer* buffer)
     if (!buffer)
         return;
 
-    UnallocateMem(buffer->data);
+    if (buffer->owned)
+        UnallocateMem(buffer->data);
     UnallocateMem(buffer);
 }
 
@@ -55,52 +75,80 @@ ACBufferReset(ACBuffer* buffer)
     buffer->len = 0;
 }
 
+/* Resizes the data to size bytes. Storage given to ACBufferWrap() is never
+ * resized, the data is moved to memory of our own instead. */
+static void
+Resize(ACBuffer* buffer, size_t size)
+{
+    if (buffer->owned) {
+        buffer->data = ReallocateMem(buffer->data, size, "buffer data");
+    } else {
+        char* data = AllocateMem(size, 1, "buffer data");
+        memcpy(data, buffer->data, buffer->len);
+        buffer->data = data;
+        buffer->owned = true;
+    }
+    buffer->capacity = size;
+}
+
+/* There is always at least one free byte after the data, so that
+ * ACBufferWriteF() can format in place. */
+static void
+MakeRoom(ACBuffer* buffer, size_t length)
+{
+    if ((buffer->len + length) >= buffer->capacity)
+        Resize(buffer, NUMMAX(buffer->capacity * 2, buffer->len + length + 1));
+}
+
+ACLIB_API void
+ACBufferReserve(ACBuffer* buffer, size_t size)
+{
+    if (!buffer)
+        return;
+
+    if (size >= buffer->capacity)
+        Resize(buffer, size + 1);
+}
+
 ACLIB_API void
 ACBufferWrite(ACBuffer* buffer, char* data, size_t length)
 {
     if (!buffer)
         return;
 
-    if ((buffer->len + length) >= buffer->capacity) {
-        size_t size = NUMMAX(buffer->capacity * 2, buffer->capacity + length);
-        buffer->data = ReallocateMem(buffer->data, size, "buffer data");
-        buffer->capacity = size;
-    }
+    MakeRoom(buffer, length);
     memcpy(buffer->data + buffer->len, data, length);
     buffer->len += length;
 }
 
-#define STRLEN 1000
 ACLIB_API void
 ACBufferWriteF(ACBuffer* buffer, char* format, ...)
 {
-    char outstr[STRLEN];
+    size_t room;
     int len;
     va_list va;
 
     if (!buffer)
         return;
 
+    /* Format straight into the free space, and again after making room if
+     * the string did not fit. */
+    room = buffer->capacity - buffer->len;
     va_start(va, format);
-    len = vsnprintf(outstr, STRLEN, format, va);
+    len = vsnprintf(buffer->data + buffer->len, room, format, va);
     va_end(va);
 
-    if (len > 0 && len <= STRLEN) {
-        ACBufferWrite(buffer, outstr, len);
-    } else {
-        char* outstr = AllocateMem(1, len + 1, "Temporary buffer");
-
+    if (len >= 0 && (size_t)len >= room) {
+        MakeRoom(buffer, len);
         va_start(va, format);
-        len = vsnprintf(outstr, len + 1, format, va);
+        len = vsnprintf(buffer->data + buffer->len, len + 1, format, va);
         va_end(va);
-
-        if (len > 0)
-            ACBufferWrite(buffer, outstr, len);
-        else
-            LogMsg(LOGERROR, FATALERROR, "Failed to write string to ACBuffer.");
-
-        UnallocateMem(outstr);
     }
+
+    if (len < 0)
+        LogMsg(LOGERROR, FATALERROR, "Failed to write string to ACBuffer.");
+    else
+        buffer->len += len;
 }
 
 ACLIB_API void
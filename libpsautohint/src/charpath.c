@@ -30,13 +30,14 @@
 #define FLATTEN 4
 #define GHOST 5
 
-static bool firstMT;
-static Cd* refPtArray = NULL;
-static ACBuffer* outbuff;
-static int masterCount;
-static const char** masterNames;
-static PathList* pathlist = NULL;
-static indx hintsMasterIx = 0; /* The index of the master we read hints from */
+#define firstMT (gContext->charpath.firstMT)
+#define refPtArray (gContext->charpath.refPtArray)
+#define outbuff (gContext->charpath.outbuff)
+#define masterCount (gContext->charpath.masterCount)
+#define masterNames (gContext->charpath.masterNames)
+#define pathlist (gContext->charpath.pathlist)
+/* The index of the master we read hints from */
+#define hintsMasterIx (gContext->charpath.hintsMasterIx)
 
 /* Prototypes */
 static void GetRelativePosition(Fixed, Fixed, Fixed, Fixed, Fixed, Fixed*);
@@ -45,9 +46,22 @@ static void GetLengthandSubrIx(int16_t, int16_t*, int16_t*);
 
 /* macros */
 #define WriteToBuffer(...) ACBufferWriteF(outbuff, __VA_ARGS__)
-#define WRTNUM(i) WriteToBuffer("%d ", (int)(i))
-#define WRTNUMA(i) WriteToBuffer("%0.2f ", round((double)(i)*100) / 100)
-#define WriteSubr(val) WriteToBuffer("%d subr ", val)
+#define WriteLiteral(str) ACBufferWrite(outbuff, str, sizeof(str) - 1)
+#define WRTNUM(i) BufferWriteInt(outbuff, (int32_t)(i))
+#define WRTNUMA(i) BufferWriteFixed(outbuff, i)
+#define WriteSubr(val)                                                         \
+    {                                                                          \
+        WRTNUM(val);                                                           \
+        WriteLiteral("subr ");                                                 \
+    }
+
+static void
+WriteOperator(int16_t op)
+{
+    char* name = GetOperator(op);
+    ACBufferWrite(outbuff, name, strlen(name));
+    WriteLiteral("\n");
+}
 
 static void
 WriteX(Fixed x)
@@ -75,7 +89,7 @@ WriteOneHintVal(Fixed val)
     if (FracPart(val) == 0)
         WRTNUM(FTrunc(val));
     else
-        WRTNUMA(FIXED2FLOAT(val));
+        WRTNUMA(val);
 }
 
 /* Locates the first CP following the given path element. */
@@ -402,7 +416,7 @@ WriteSbandWidth(void)
                 WriteSubr(subrix);
         }
     }
-    WriteToBuffer("sbx\n");
+    WriteLiteral("sbx\n");
 }
 
 static bool
@@ -1027,7 +1041,7 @@ WriteFlex(indx eltix)
         refPtArray[ix].y =
           (vert ? pathlist[ix].path[eltix].y3 : pathlist[ix].path[eltix].y);
     }
-    WriteToBuffer("1 subr\n");
+    WriteLiteral("1 subr\n");
     for (j = 0; j < 8; j++) {
         int16_t opcount;
         if (j == 7)
@@ -1108,7 +1122,7 @@ WriteFlex(indx eltix)
                 WriteY(coord.y); /* usually=0. cf bottom of "CheckFlexValues" */
         }
     } /* end of j for loop */
-    WriteToBuffer("0 subr\n");
+    WriteLiteral("0 subr\n");
     UnallocateMem(refPtArray);
 }
 
@@ -1126,7 +1140,7 @@ WriteUnmergedHints(indx pathEltIx, indx mIx)
         hintList = pathlist[mIx].path[pathEltIx].hints;
 
     if (pathEltIx != MAINHINTS)
-        WriteToBuffer("beginsubr snc\n");
+        WriteLiteral("beginsubr snc\n");
 
     while (hintList != NULL) {
         int16_t hinttype = hintList->type;
@@ -1141,16 +1155,16 @@ WriteUnmergedHints(indx pathEltIx, indx mIx)
         WriteOneHintVal(hintList->rightortop);
         switch (hinttype) {
             case RB:
-                WriteToBuffer("rb\n");
+                WriteLiteral("rb\n");
                 break;
             case RV + ESCVAL:
-                WriteToBuffer("rv\n");
+                WriteLiteral("rv\n");
                 break;
             case RY:
-                WriteToBuffer("ry\n");
+                WriteLiteral("ry\n");
                 break;
             case RM + ESCVAL:
-                WriteToBuffer("rm\n");
+                WriteLiteral("rm\n");
                 break;
             default:
                 LogMsg(LOGERROR, NONFATALERROR, "Illegal hint type: %d",
@@ -1164,7 +1178,7 @@ WriteUnmergedHints(indx pathEltIx, indx mIx)
     } /* end of while */
 
     if (pathEltIx != MAINHINTS)
-        WriteToBuffer("endsubr enc\nnewcolors\n");
+        WriteLiteral("endsubr enc\nnewcolors\n");
 
     UnallocateMem(hintList);
 }
@@ -1190,7 +1204,7 @@ WriteHints(indx pathEltIx)
           (pathEltIx == MAINHINTS ? pathlist[ix].mainhints
                                   : pathlist[ix].path[pathEltIx].hints);
     if (pathEltIx != MAINHINTS)
-        WriteToBuffer("beginsubr snc\n");
+        WriteLiteral("beginsubr snc\n");
     while (hintArray[0] != NULL) {
         bool lbsame, rtsame;
         indx startix = 0;
@@ -1263,16 +1277,16 @@ WriteHints(indx pathEltIx)
         }
         switch (hinttype) {
             case RB:
-                WriteToBuffer("rb\n");
+                WriteLiteral("rb\n");
                 break;
             case RV + ESCVAL:
-                WriteToBuffer("rv\n");
+                WriteLiteral("rv\n");
                 break;
             case RY:
-                WriteToBuffer("ry\n");
+                WriteLiteral("ry\n");
                 break;
             case RM + ESCVAL:
-                WriteToBuffer("rm\n");
+                WriteLiteral("rm\n");
                 break;
             default:
                 LogMsg(LOGERROR, NONFATALERROR, "Illegal hint type: %d.",
@@ -1283,7 +1297,7 @@ WriteHints(indx pathEltIx)
               (hintArray[ix]->next == NULL) ? NULL : hintArray[ix]->next;
     } /* end of while */
     if (pathEltIx != MAINHINTS)
-        WriteToBuffer("endsubr enc\nnewcolors\n");
+        WriteLiteral("endsubr enc\nnewcolors\n");
     UnallocateMem(hintArray);
 }
 
@@ -1468,7 +1482,7 @@ WritePaths(ACBuffer** outBuffers)
         if (gAddHints && (pathlist[hintsMasterIx].mainhints != NULL))
             WriteUnmergedHints(MAINHINTS, mIx);
 
-        WriteToBuffer("sc\n");
+        WriteLiteral("sc\n");
         for (eltix = 0; eltix < gPathEntries; eltix++) {
             GlyphPathElt elt = path.path[eltix];
             op = elt.type;
@@ -1490,9 +1504,9 @@ WritePaths(ACBuffer** outBuffers)
 
             WritePathElt(mIx, eltix, op, 0, opcount);
 
-            WriteToBuffer("%s\n", GetOperator(op));
+            WriteOperator(op);
         }
-        WriteToBuffer("ed\n");
+        WriteLiteral("ed\n");
     }
     return;
 #endif /* DONT_COMBINE_PATHS */
@@ -1505,7 +1519,7 @@ WritePaths(ACBuffer** outBuffers)
     WriteSbandWidth();
     if (gAddHints && (pathlist[hintsMasterIx].mainhints != NULL))
         WriteHints(MAINHINTS);
-    WriteToBuffer("sc\n");
+    WriteLiteral("sc\n");
     firstMT = true;
     for (eltix = 0; eltix < gPathEntries; eltix++) {
         xequal = yequal = false;
@@ -1584,9 +1598,9 @@ WritePaths(ACBuffer** outBuffers)
                 if (subrIx >= 0 && op != CP)
                     WriteSubr(subrIx);
             } /* end of for opix */
-        WriteToBuffer("%s\n", GetOperator(op));
+        WriteOperator(op);
     } /* end of for eltix */
-    WriteToBuffer("ed\n");
+    WriteLiteral("ed\n");
 }
 
 /* Returns number of operands for the given operator. */
@@ -28,15 +28,14 @@ typedef struct {
   int32_t rx, ry, rx1, ry1, rx2, ry2, rx3, ry3;  /* relative coordinates */
   } GlyphPathElt;
 
-typedef struct {
+typedef struct _t_pathlist {
   GlyphPathElt* path;
   HintElt* mainhints;
   int32_t sb;
   int16_t width;
 } PathList;
 
-extern int32_t gPathEntries;  /* number of elements in a glyph path */
-extern bool gAddHints;  /* whether to include hints in the font */
+#define gPathEntries (gContext->pathEntries)
 
 GlyphPathElt* AppendGlyphPathElement(int);
 
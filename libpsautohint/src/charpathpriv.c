@@ -14,13 +14,10 @@
 #include "charpath.h"
 #include "memory.h"
 
-int32_t gPathEntries = 0; /* number of elements in a glyph path */
-bool gAddHints = true;    /* whether to include hints in the font */
-
 #define MAXPATHELT 100 /* initial maximum number of path elements */
 
-static int32_t maxPathEntries = 0;
-static PathList* currPathList = NULL;
+#define maxPathEntries (gContext->charpath.maxPathEntries)
+#define currPathList (gContext->charpath.currPathList)
 
 static void CheckPath(void);
 
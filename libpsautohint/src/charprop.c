@@ -9,17 +9,9 @@
 
 #include "ac.h"
 
-/* number of default entries in counter hint glyph list. */
-#define COUNTERDEFAULTENTRIES 4
-#define COUNTERLISTSIZE 20
-
-char* gVHintList[] = { "m",  "M",  "T",  "ellipsis", NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL,       NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL,       NULL, NULL };
-char* gHHintList[] = { "element", "equivalence", "notelement", "divide", NULL,
-                       NULL,      NULL,          NULL,         NULL,     NULL,
-                       NULL,      NULL,          NULL,         NULL,     NULL,
-                       NULL,      NULL,          NULL,         NULL,     NULL };
+static char* VHintDefaults[] = { "m", "M", "T", "ellipsis", NULL };
+static char* HHintDefaults[] = { "element", "equivalence", "notelement",
+                                 "divide", NULL };
 
 static char* UpperSpecialGlyphs[] = { "questiondown", "exclamdown", "semicolon",
                                       NULL };
@@ -29,61 +21,170 @@ static char* LowerSpecialGlyphs[] = { "question", "exclam", "colon", NULL };
 static char* NoBlueList[] = { "at",       "bullet",     "copyright",
                               "currency", "registered", NULL };
 
-bool
-FindNameInList(char* nm, char** lst)
+/* The glyph names with special handling are kept in a hash table (open
+ * addressing, linear probing) mapping each name to its GLYPH* classes. It is
+ * filled when the font info is parsed and only read while hinting, so the
+ * same table can be used by several threads. */
+
+#define MINNAMESETSIZE 64
+
+static uint32_t
+HashName(const char* name, size_t len)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/* Returns the slot holding name, or the empty slot where it would go. */
+static GlyphNameEntry*
+FindGlyphName(const GlyphNameSet* set, const char* name, size_t len)
 {
-    char** l = lst;
+    size_t mask = set->size - 1;
+    size_t i = HashName(name, len) & mask;
+
     while (true) {
-        char* lnm = *l;
-        if (lnm == NULL)
+        GlyphNameEntry* entry = &set->entries[i];
+        if (entry->name == NULL ||
+            (strncmp(entry->name, name, len) == 0 && entry->name[len] == '\0'))
+            return entry;
+        i = (i + 1) & mask;
+    }
+}
+
+static bool
+GrowGlyphNameSet(GlyphNameSet* set)
+{
+    GlyphNameSet grown;
+    size_t i;
+
+    grown.size = set->size ? set->size * 2 : MINNAMESETSIZE;
+    grown.count = set->count;
+    grown.entries = (GlyphNameEntry*)AllocateMem(
+      grown.size, sizeof(GlyphNameEntry), "glyph name set");
+    if (grown.entries == NULL)
+        return false;
+
+    for (i = 0; i < set->size; i++) {
+        GlyphNameEntry* entry = &set->entries[i];
+        if (entry->name != NULL)
+            *FindGlyphName(&grown, entry->name, strlen(entry->name)) = *entry;
+    }
+
+    UnallocateMem(set->entries);
+    *set = grown;
+    return true;
+}
+
+/* Adds classes to the glyph name (the first len characters of name),
+ * returns false if the name already had them or can't be added. */
+static bool
+AddGlyphName(GlyphNameSet* set, const char* name, size_t len,
+             unsigned int classes)
+{
+    GlyphNameEntry* entry;
+
+    /* keep the table at most half full */
+    if (2 * (set->count + 1) > set->size && !GrowGlyphNameSet(set))
+        return false;
+
+    entry = FindGlyphName(set, name, len);
+    if (entry->name == NULL) {
+        entry->name = AllocateMem(1, len + 1, "glyph name");
+        if (entry->name == NULL)
             return false;
-        if (strcmp(lnm, nm) == 0)
-            return true;
-        l++;
+        memcpy(entry->name, name, len);
+        set->count++;
+    } else if ((entry->classes & classes) == classes) {
+        return false;
     }
+    entry->classes |= classes;
+    return true;
+}
+
+static void
+AddGlyphNames(GlyphNameSet* set, char** names, unsigned int classes)
+{
+    for (; *names != NULL; names++)
+        AddGlyphName(set, *names, strlen(*names), classes);
+}
+
+/* Sets up the glyph name set of fontinfo with the built-in names. */
+void
+InitGlyphNameSet(ACFontInfo* fontinfo)
+{
+    GlyphNameSet* set = &fontinfo->glyphNames;
+
+    memset(set, 0, sizeof(*set));
+    AddGlyphNames(set, VHintDefaults, VCOUNTERGLYPH);
+    AddGlyphNames(set, HHintDefaults, HCOUNTERGLYPH);
+    AddGlyphNames(set, UpperSpecialGlyphs, UPPERSPECIALGLYPH);
+    AddGlyphNames(set, LowerSpecialGlyphs, LOWERSPECIALGLYPH);
+    AddGlyphNames(set, NoBlueList, NOBLUEGLYPH);
+}
+
+void
+FreeGlyphNameSet(ACFontInfo* fontinfo)
+{
+    GlyphNameSet* set = &fontinfo->glyphNames;
+    size_t i;
+
+    for (i = 0; i < set->size; i++)
+        UnallocateMem(set->entries[i].name);
+    UnallocateMem(set->entries);
+    memset(set, 0, sizeof(*set));
 }
 
-/* Adds specified glyphs to CounterHintList array. */
+/* Adds the glyphs of charlist to the counter hint glyphs of the given class,
+ * returns the number of glyphs added. The charlist is not modified, as the
+ * same font info may be in use by several threads. */
 int
-AddCounterHintGlyphs(char* charlist, char* HintList[])
+AddCounterHintGlyphs(ACFontInfo* fontinfo, const char* charlist,
+                     unsigned int counterClass)
 {
     const char* setList = "(), \t\n\r";
-    char* token;
-    bool firstTime = true;
-    int16_t ListEntries = COUNTERDEFAULTENTRIES;
+    const char* next = charlist;
+    int added = 0;
 
     while (true) {
-        if (firstTime) {
-            token = (char*)strtok(charlist, setList);
-            firstTime = false;
-        } else
-            token = (char*)strtok(NULL, setList);
-        if (token == NULL)
-            break;
-        if (FindNameInList(token, HintList))
-            continue;
-        /* Currently, HintList must end with a NULL pointer. */
-        if (ListEntries == (COUNTERLISTSIZE - 1)) {
-            LogMsg(WARNING, OK,
-                   "Exceeded counter hints list size. (maximum is %d.) "
-                   "Cannot add %s or subsequent characters.",
-                   (int)COUNTERLISTSIZE, token);
+        size_t len;
+
+        next += strspn(next, setList);
+        if (*next == '\0')
             break;
-        }
-        HintList[ListEntries] =
-          AllocateMem(1, strlen(token) + 1, "counter hints list");
-        strcpy(HintList[ListEntries++], token);
+        len = strcspn(next, setList);
+        if (AddGlyphName(&fontinfo->glyphNames, next, len, counterClass))
+            added++;
+        next += len;
     }
-    return (ListEntries - COUNTERDEFAULTENTRIES);
+    return added;
+}
+
+static unsigned int
+GlyphClasses(void)
+{
+    const GlyphNameSet* set = gGlyphNames;
+
+    if (set == NULL || set->size == 0)
+        return 0;
+    return FindGlyphName(set, gGlyphName, strlen(gGlyphName))->classes;
 }
 
 int32_t
 SpecialGlyphType(void)
 {
     /* 1 = upper; -1 = lower; 0 = neither */
-    if (FindNameInList(gGlyphName, UpperSpecialGlyphs))
+    unsigned int classes = GlyphClasses();
+
+    if (classes & UPPERSPECIALGLYPH)
         return 1;
-    if (FindNameInList(gGlyphName, LowerSpecialGlyphs))
+    if (classes & LOWERSPECIALGLYPH)
         return -1;
     return 0;
 }
@@ -91,19 +192,19 @@ SpecialGlyphType(void)
 bool
 HHintGlyph(void)
 {
-    return FindNameInList(gGlyphName, gHHintList);
+    return GlyphClasses() & HCOUNTERGLYPH;
 }
 
 bool
 VHintGlyph(void)
 {
-    return FindNameInList(gGlyphName, gVHintList);
+    return GlyphClasses() & VCOUNTERGLYPH;
 }
 
 bool
 NoBlueGlyph(void)
 {
-    return FindNameInList(gGlyphName, NoBlueList);
+    return GlyphClasses() & NOBLUEGLYPH;
 }
 
 bool
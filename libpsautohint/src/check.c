@@ -11,16 +11,43 @@
 
 #include "ac.h"
 
-static bool g_xflat, g_yflat, g_xdone, g_ydone, g_bbquit;
-static int32_t g_xstate, g_ystate, g_xstart, g_ystart;
-static Fixed g_x0, g_cy0, g_x1, g_cy1, g_xloc, g_yloc;
-static Fixed g_x, g_y, g_xnxt, g_ynxt;
-static Fixed g_yflatstartx, g_yflatstarty, g_yflatendx, g_yflatendy;
-static Fixed g_xflatstarty, g_xflatstartx, g_xflatendx, g_xflatendy;
-static bool g_vert, g_started, g_reCheckSmooth;
-static Fixed g_loc, g_frst, g_lst, g_fltnvalue;
-static PathElt* g_e;
-static bool g_forMultiMaster = false, g_inflPtFound = false;
+#define g_xflat (gContext->check.g_xflat)
+#define g_yflat (gContext->check.g_yflat)
+#define g_xdone (gContext->check.g_xdone)
+#define g_ydone (gContext->check.g_ydone)
+#define g_bbquit (gContext->check.g_bbquit)
+#define g_xstate (gContext->check.g_xstate)
+#define g_ystate (gContext->check.g_ystate)
+#define g_xstart (gContext->check.g_xstart)
+#define g_ystart (gContext->check.g_ystart)
+#define g_x0 (gContext->check.g_x0)
+#define g_cy0 (gContext->check.g_cy0)
+#define g_x1 (gContext->check.g_x1)
+#define g_cy1 (gContext->check.g_cy1)
+#define g_xloc (gContext->check.g_xloc)
+#define g_yloc (gContext->check.g_yloc)
+#define g_x (gContext->check.g_x)
+#define g_y (gContext->check.g_y)
+#define g_xnxt (gContext->check.g_xnxt)
+#define g_ynxt (gContext->check.g_ynxt)
+#define g_yflatstartx (gContext->check.g_yflatstartx)
+#define g_yflatstarty (gContext->check.g_yflatstarty)
+#define g_yflatendx (gContext->check.g_yflatendx)
+#define g_yflatendy (gContext->check.g_yflatendy)
+#define g_xflatstarty (gContext->check.g_xflatstarty)
+#define g_xflatstartx (gContext->check.g_xflatstartx)
+#define g_xflatendx (gContext->check.g_xflatendx)
+#define g_xflatendy (gContext->check.g_xflatendy)
+#define g_vert (gContext->check.g_vert)
+#define g_started (gContext->check.g_started)
+#define g_reCheckSmooth (gContext->check.g_reCheckSmooth)
+#define g_loc (gContext->check.g_loc)
+#define g_frst (gContext->check.g_frst)
+#define g_lst (gContext->check.g_lst)
+#define g_fltnvalue (gContext->check.g_fltnvalue)
+#define g_e (gContext->check.g_e)
+#define g_forMultiMaster (gContext->check.g_forMultiMaster)
+#define g_inflPtFound (gContext->check.g_inflPtFound)
 
 #define STARTING (0)
 #define goingUP (1)
@@ -233,6 +260,14 @@ chkDT(Cd c)
     g_yloc = g_ynxt;
 }
 
+static void
+chkDTs(const Cd* pts, int32_t cnt)
+{
+    int32_t i;
+    for (i = 0; i < cnt; i++)
+        chkDT(pts[i]);
+}
+
 #define FQ(x) ((int32_t)((x) >> 6))
 static int32_t
 CPDirection(Fixed x1, Fixed cy1, Fixed x2, Fixed y2, Fixed x3, Fixed y3)
@@ -306,7 +341,7 @@ GetInflectionPoint(Fixed px, Fixed py, Fixed px1, Fixed pcy1, Fixed px2,
     FltnRec fltnrec;
     Cd c0, c1, c2, c3;
 
-    fltnrec.report = chkDT;
+    fltnrec.report = chkDTs;
     c0.x = px;
     c0.y = -py;
     c1.x = px1;
@@ -340,7 +375,7 @@ CheckSCurve(PathElt* ee)
     }
 
     GetEndPoint(ee->prev, &c0.x, &c0.y);
-    fr.report = chkDT;
+    fr.report = chkDTs;
     c1.x = ee->x1;
     c1.y = ee->y1;
     c2.x = ee->x2;
@@ -471,6 +506,14 @@ chkBBDT(Cd c)
     }
 }
 
+static void
+chkBBDTs(const Cd* pts, int32_t cnt)
+{
+    int32_t i;
+    for (i = 0; i < cnt && !g_bbquit; i++)
+        chkBBDT(pts[i]);
+}
+
 void
 CheckForMultiMoveTo(void)
 {
@@ -498,7 +541,7 @@ CheckBBoxEdge(PathElt* e, bool vrt, Fixed lc, Fixed* pf, Fixed* pl)
     }
 
     GetEndPoint(e->prev, &c0.x, &c0.y);
-    fr.report = chkBBDT;
+    fr.report = chkBBDTs;
     g_bbquit = false;
     c1.x = e->x1;
     c1.y = e->y1;
@@ -13,7 +13,8 @@
 static void DoHStems(HintVal* sLst1);
 static void DoVStems(HintVal* sLst);
 
-static bool CounterFailed;
+#define CounterFailed (gContext->counterFailed)
+#define PathSnap (gContext->pathSnap)
 
 void
 InitAll(int32_t reason)
@@ -182,7 +183,7 @@ AddHintPoint(Fixed x0, Fixed y0, Fixed x1, Fixed y1, char ch, PathElt* p0,
     if (chk == -1) {
         pt->next = gPointList;
         gPointList = pt;
-        LogHintInfo(gPointList);
+        DebugReport(LogHintInfo(gPointList));
     }
 }
 
@@ -373,7 +374,7 @@ XtraHints(PathElt* e)
 }
 
 static void
-Blues(unsigned char* links)
+Blues(SubpathLinks* links)
 {
     Fixed pv = 0, pd = 0, pc = 0, pb = 0, pa = 0;
     HintVal* sLst;
@@ -535,7 +536,7 @@ Blues(unsigned char* links)
     if (NoBlueGlyph()) {
         gLenTopBands = gLenBotBands = 0;
     }
-    GenHPts();
+    TimePhase(genHPtsNs, GenHPts());
     LogMsg(LOGDEBUG, OK, "evaluate");
     if (!CounterFailed && HHintGlyph()) {
         pv = gPruneValue;
@@ -549,12 +550,12 @@ Blues(unsigned char* links)
         pb = gPruneB;
         gPruneB = (Fixed)gMinVal;
     }
-    EvalH();
-    PruneHVals();
+    TimePhase(evalHNs, EvalH());
+    TimePhase(pruneHValsNs, PruneHVals());
     FindBestHVals();
-    MergeVals(false);
+    TimePhase(mergeValsNs, MergeVals(false));
 
-    ShowHVals(gValList);
+    DebugReport(ShowHVals(gValList));
     LogMsg(LOGDEBUG, OK, "pick best");
     MarkLinks(gValList, true, links);
     CheckVals(gValList, false);
@@ -592,7 +593,7 @@ Blues(unsigned char* links)
     }
     LogMsg(LOGDEBUG, OK, "results");
     LogMsg(LOGDEBUG, OK, gUseH ? "rv" : "rb");
-    ShowHVals(gHHinting);
+    DebugReport(ShowHVals(gHHinting));
     if (gUseH) {
         LogMsg(INFO, OK, "Using H counter hints.");
     }
@@ -639,12 +640,12 @@ DoHStems(HintVal* sLst1)
 }
 
 static void
-Yellows(unsigned char* links)
+Yellows(SubpathLinks* links)
 {
     Fixed pv = 0, pd = 0, pc = 0, pb = 0, pa = 0;
     HintVal* sLst;
     LogMsg(LOGDEBUG, OK, "generate yellows");
-    GenVPts(SpecialGlyphType());
+    TimePhase(genVPtsNs, GenVPts(SpecialGlyphType()));
     LogMsg(LOGDEBUG, OK, "evaluate");
     if (!CounterFailed && VHintGlyph()) {
         pv = gPruneValue;
@@ -658,11 +659,11 @@ Yellows(unsigned char* links)
         pb = gPruneB;
         gPruneB = (Fixed)gMinVal;
     }
-    EvalV();
-    PruneVVals();
+    TimePhase(evalVNs, EvalV());
+    TimePhase(pruneVValsNs, PruneVVals());
     FindBestVVals();
-    MergeVals(true);
-    ShowVVals(gValList);
+    TimePhase(mergeValsNs, MergeVals(true));
+    DebugReport(ShowVVals(gValList));
     LogMsg(LOGDEBUG, OK, "pick best");
     MarkLinks(gValList, false, links);
     CheckVals(gValList, true);
@@ -696,7 +697,7 @@ Yellows(unsigned char* links)
     }
     LogMsg(LOGDEBUG, OK, "results");
     LogMsg(LOGDEBUG, OK, gUseV ? "rm" : "ry");
-    ShowVVals(gVHinting);
+    DebugReport(ShowVVals(gVHinting));
     if (gUseV) {
         LogMsg(INFO, OK, "Using V counter hints.");
     }
@@ -778,16 +779,65 @@ AddHintsSetup(void)
     /* PreCheckForSolEol(); */
 }
 
+static bool
+ReadGlyphSource(const GlyphSource* glyph)
+{
+    if (glyph->bez != NULL)
+        return ReadGlyph(glyph->bez, false, false);
+    return ReadGlyphPath(glyph->name, glyph->path, glyph->pathLength);
+}
+
+/* Copies the path as AddHintsSetup() leaves it, so that a retry can start
+ * from it again without reading the glyph. The copy is outside the arena,
+ * which InitAll(RESTART) clears. */
+static void
+SavePathSnapshot(void)
+{
+    PathElt* e;
+    int32_t len = 0;
+    for (e = gPathStart; e != NULL; e = e->next)
+        len++;
+    if (len > PathSnap.max) {
+        PathSnap.elts = (PathElt*)ReallocateMem(
+          PathSnap.elts, len * sizeof(PathElt), "path snapshot");
+        PathSnap.max = len;
+    }
+    PathSnap.len = 0;
+    for (e = gPathStart; e != NULL; e = e->next)
+        PathSnap.elts[PathSnap.len++] = *e;
+    memcpy(PathSnap.glyphName, gGlyphName, MAX_GLYPHNAME_LEN);
+}
+
+/* Rebuilds the path from the snapshot in one block of the arena. */
+static void
+RestorePathSnapshot(void)
+{
+    int32_t i, len = PathSnap.len;
+    PathElt* elts;
+    memcpy(gGlyphName, PathSnap.glyphName, MAX_GLYPHNAME_LEN);
+    gPathStart = gPathEnd = NULL;
+    if (len == 0)
+        return;
+    elts = (PathElt*)Alloc(len * (int32_t)sizeof(PathElt));
+    memcpy(elts, PathSnap.elts, len * sizeof(PathElt));
+    for (i = 0; i < len; i++) {
+        elts[i].prev = i > 0 ? &elts[i - 1] : NULL;
+        elts[i].next = i < len - 1 ? &elts[i + 1] : NULL;
+    }
+    gPathStart = &elts[0];
+    gPathEnd = &elts[len - 1];
+}
+
 /* If extrahint is true then it is ok to have multi-level
  hinting. */
 static void
-AddHintsInnerLoop(const char* srcglyph, bool extrahint)
+AddHintsInnerLoop(bool extrahint)
 {
     int32_t retryHinting = 0;
-    unsigned char* links;
+    SubpathLinks* links;
 
     while (true) {
-        PreGenPts();
+        TimePhase(preGenPtsNs, PreGenPts());
         CheckSmooth();
         links = InitShuffleSubpaths();
         Blues(links);
@@ -795,14 +845,14 @@ AddHintsInnerLoop(const char* srcglyph, bool extrahint)
             Yellows(links);
         }
         if (gEditGlyph) {
-            DoShuffleSubpaths(links);
+            TimePhase(shuffleSubpathsNs, DoShuffleSubpaths(links));
         }
         gHPrimary = CopyHints(gHHinting);
         gVPrimary = CopyHints(gVHinting);
         PruneElementHintSegs();
-        ListHintInfo();
+        DebugReport(ListHintInfo());
         if (extrahint) {
-            AutoExtraHints(MoveToNewHints());
+            TimePhase(autoExtraHintsNs, AutoExtraHints(MoveToNewHints()));
         }
         gPtLstArray[gPtLstIndex] = gPointList;
         retryHinting++;
@@ -829,11 +879,11 @@ AddHintsInnerLoop(const char* srcglyph, bool extrahint)
 
         /* SaveFile(); SaveFile is always called in AddHintsCleanup, so this is
          * a duplciate */
+        CountStat(retries, 1);
         InitAll(RESTART);
-        if (gWriteHintedBez && !ReadGlyph(srcglyph, false, false)) {
-            break;
+        if (gWriteHintedBez) {
+            RestorePathSnapshot();
         }
-        AddHintsSetup();
         if (!PreCheckForHinting()) {
             break;
         }
@@ -854,24 +904,26 @@ AddHintsCleanup(void)
             LogMsg(LOGERROR, NONFATALERROR,
                    "The glyph path vanished while adding hints.");
         } else {
-            SaveFile();
+            TimePhase(saveFileNs, SaveFile());
         }
     }
     InitAll(RESTART);
 }
 
 static void
-AddHints(const char* srcglyph, bool extrahint)
+AddHints(bool extrahint)
 {
     if (gPathStart == NULL || gPathStart == gPathEnd) {
         LogMsg(INFO, OK, "No glyph path, so no hints.");
-        SaveFile(); /* make sure it gets saved with no hinting */
+        /* make sure it gets saved with no hinting */
+        TimePhase(saveFileNs, SaveFile());
         return;
     }
     CounterFailed = gBandError = false;
     CheckPathBBox();
     CheckForDups();
     AddHintsSetup();
+    SavePathSnapshot();
     if (!PreCheckForHinting()) {
         return;
     }
@@ -879,18 +931,23 @@ AddHints(const char* srcglyph, bool extrahint)
         gHasFlex = false;
         AutoAddFlex();
     }
-    AddHintsInnerLoop(srcglyph, extrahint);
+    AddHintsInnerLoop(extrahint);
     AddHintsCleanup();
 }
 
 bool
-AutoHintGlyph(const char* srcglyph, bool extrahint)
+AutoHintGlyph(const GlyphSource* glyph, bool extrahint)
 {
     int32_t lentop = gLenTopBands, lenbot = gLenBotBands;
-    if (!ReadGlyph(srcglyph, false, false)) {
+    bool read;
+    TimePhase(readGlyphNs, read = ReadGlyphSource(glyph));
+    if (!read) {
         LogMsg(LOGERROR, NONFATALERROR, "Cannot parse glyph.");
     }
-    AddHints(srcglyph, extrahint);
+    if (gStats) {
+        memcpy(gStats->glyphName, gGlyphName, MAX_GLYPHNAME_LEN);
+    }
+    AddHints(extrahint);
     gLenTopBands = lentop;
     gLenBotBands = lenbot;
     return true;
@@ -308,12 +308,91 @@ VStemMiss(HintSeg* leftSeg, HintSeg* rightSeg)
                          (rightSeg->sType == sCURVE));
 }
 
+/* The values found by EvalV and EvalH, in the order they were found. They
+ * are sorted and linked into gValList once all of them are known. */
+typedef struct {
+    HintVal* vals;
+    int32_t cnt, max;
+} ValCands;
+
+static HintVal*
+NewValCand(ValCands* cands)
+{
+    if (cands->cnt == cands->max) {
+        HintVal* vals;
+        cands->max = cands->max > 0 ? 2 * cands->max : 256;
+        vals = (HintVal*)Alloc(cands->max * sizeof(HintVal));
+        if (cands->cnt > 0)
+            memcpy(vals, cands->vals, cands->cnt * sizeof(HintVal));
+        cands->vals = vals;
+    }
+    return &cands->vals[cands->cnt++];
+}
+
+/* The list used to be built by inserting each value in front of the first
+ * one with the same or a greater (loc1, loc2), so values with equal
+ * locations are kept in the reverse of the order they were found in. For H
+ * values the key is (loc2, loc1). */
+typedef struct {
+    Fixed key1, key2;
+    int32_t idx;
+} ValKey;
+
+static int
+CompareValKeys(const void* a, const void* b)
+{
+    const ValKey* ka = a;
+    const ValKey* kb = b;
+    if (ka->key1 != kb->key1)
+        return ka->key1 < kb->key1 ? -1 : 1;
+    if (ka->key2 != kb->key2)
+        return ka->key2 < kb->key2 ? -1 : 1;
+    return ka->idx > kb->idx ? -1 : ka->idx < kb->idx;
+}
+
+static ValKey*
+SortValCands(ValCands* cands, bool hFlg)
+{
+    int32_t i;
+    ValKey* keys;
+    if (cands->cnt == 0)
+        return NULL;
+    keys = (ValKey*)Alloc(cands->cnt * sizeof(ValKey));
+    for (i = 0; i < cands->cnt; i++) {
+        HintVal* v = &cands->vals[i];
+        keys[i].key1 = hFlg ? v->vLoc2 : v->vLoc1;
+        keys[i].key2 = hFlg ? v->vLoc1 : v->vLoc2;
+        keys[i].idx = i;
+    }
+    qsort(keys, cands->cnt, sizeof(ValKey), CompareValKeys);
+    return keys;
+}
+
+/* Copies the values to one array in list order and links them up. */
+static void
+LinkValCands(ValCands* cands, bool hFlg)
+{
+    int32_t i;
+    ValKey* keys;
+    HintVal* vals;
+    gValList = NULL;
+    CountStat(candidateValues, cands->cnt);
+    if (cands->cnt == 0)
+        return;
+    keys = SortValCands(cands, hFlg);
+    vals = (HintVal*)Alloc(cands->cnt * sizeof(HintVal));
+    for (i = 0; i < cands->cnt; i++) {
+        vals[i] = cands->vals[keys[i].idx];
+        vals[i].vNxt = (i + 1 < cands->cnt) ? &vals[i + 1] : NULL;
+    }
+    gValList = vals;
+}
+
 static void
-InsertVValue(Fixed lft, Fixed rght, Fixed val, Fixed spc, HintSeg* lSeg,
-             HintSeg* rSeg)
+InsertVValue(ValCands* cands, Fixed lft, Fixed rght, Fixed val, Fixed spc,
+             HintSeg* lSeg, HintSeg* rSeg)
 {
-    HintVal *item, *vlist, *vprev;
-    item = (HintVal*)Alloc(sizeof(HintVal));
+    HintVal* item = NewValCand(cands);
     item->vVal = val;
     item->initVal = val;
     item->vLoc1 = lft;
@@ -322,33 +401,14 @@ InsertVValue(Fixed lft, Fixed rght, Fixed val, Fixed spc, HintSeg* lSeg,
     item->vSeg1 = lSeg;
     item->vSeg2 = rSeg;
     item->vGhst = false;
-    vlist = gValList;
-    vprev = NULL;
-    while (vlist != NULL) {
-        if (vlist->vLoc1 >= lft)
-            break;
-        vprev = vlist;
-        vlist = vlist->vNxt;
-    }
-    while (vlist != NULL && vlist->vLoc1 == lft) {
-        if (vlist->vLoc2 >= rght)
-            break;
-        vprev = vlist;
-        vlist = vlist->vNxt;
-    }
-    if (vprev == NULL)
-        gValList = item;
-    else
-        vprev->vNxt = item;
-    item->vNxt = vlist;
-    ReportAddVVal(item);
+    DebugReport(ReportAddVVal(item));
 }
 
 #define LePruneValue(val) ((val) < FixOne && ((val) << 10) <= gPruneValue)
 
 static void
-AddVValue(Fixed lft, Fixed rght, Fixed val, Fixed spc, HintSeg* lSeg,
-          HintSeg* rSeg)
+AddVValue(ValCands* cands, Fixed lft, Fixed rght, Fixed val, Fixed spc,
+          HintSeg* lSeg, HintSeg* rSeg)
 {
     if (val == 0)
         return;
@@ -364,39 +424,49 @@ AddVValue(Fixed lft, Fixed rght, Fixed val, Fixed spc, HintSeg* lSeg,
     }
     if (rSeg == NULL)
         return;
-    InsertVValue(lft, rght, val, spc, lSeg, rSeg);
+    InsertVValue(cands, lft, rght, val, spc, lSeg, rSeg);
 }
 
-static void
-InsertHValue(Fixed bot, Fixed top, Fixed val, Fixed spc, HintSeg* bSeg,
-             HintSeg* tSeg, bool ghst)
+/* Index of the first of the sorted H values at (bot, top) or after it. */
+static int32_t
+FirstHValAt(const ValKey* keys, int32_t cnt, Fixed bot, Fixed top)
 {
-    HintVal *item, *vlist, *vprev, *vl;
-    vlist = gValList;
-    vprev = NULL;
-    while (vlist != NULL) {
-        if (vlist->vLoc2 >= top)
-            break;
-        vprev = vlist;
-        vlist = vlist->vNxt;
-    }
-    while (vlist != NULL && vlist->vLoc2 == top) {
-        if (vlist->vLoc1 >= bot)
-            break;
-        vprev = vlist;
-        vlist = vlist->vNxt;
+    int32_t lo = 0, hi = cnt;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (keys[mid].key1 < top ||
+            (keys[mid].key1 == top && keys[mid].key2 < bot))
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    /* prune ghost pair that is same as non ghost pair for same segment
- only if val for ghost is less than an existing val with same
- top and bottom segment (vl) */
-    vl = vlist;
-    while (ghst && vl != NULL && vl->vLoc2 == top && vl->vLoc1 == bot) {
+    return lo;
+}
+
+/* Ghost values are all added after the other ones, so the sorted non ghost
+ * values are looked up here instead of walking the list. */
+static bool
+PruneGhostHValue(ValCands* cands, const ValKey* keys, int32_t cnt, Fixed bot,
+                 Fixed top, Fixed val, HintSeg* bSeg, HintSeg* tSeg)
+{
+    int32_t i = FirstHValAt(keys, cnt, bot, top);
+    for (; i < cnt && keys[i].key1 == top && keys[i].key2 == bot; i++) {
+        HintVal* vl = &cands->vals[keys[i].idx];
+        /* prune ghost pair that is same as non ghost pair for same segment
+         only if val for ghost is less than an existing val with same
+         top and bottom segment (vl) */
         if (!vl->vGhst && (vl->vSeg1 == bSeg || vl->vSeg2 == tSeg) &&
             vl->vVal > val)
-            return;
-        vl = vl->vNxt;
+            return true;
     }
-    item = (HintVal*)Alloc(sizeof(HintVal));
+    return false;
+}
+
+static void
+InsertHValue(ValCands* cands, Fixed bot, Fixed top, Fixed val, Fixed spc,
+             HintSeg* bSeg, HintSeg* tSeg, bool ghst)
+{
+    HintVal* item = NewValCand(cands);
     item->vVal = val;
     item->initVal = val;
     item->vSpc = spc;
@@ -405,17 +475,12 @@ InsertHValue(Fixed bot, Fixed top, Fixed val, Fixed spc, HintSeg* bSeg,
     item->vSeg1 = bSeg;
     item->vSeg2 = tSeg;
     item->vGhst = ghst;
-    if (vprev == NULL)
-        gValList = item;
-    else
-        vprev->vNxt = item;
-    item->vNxt = vlist;
-    ReportAddHVal(item);
+    DebugReport(ReportAddHVal(item));
 }
 
 static void
-AddHValue(Fixed bot, Fixed top, Fixed val, Fixed spc, HintSeg* bSeg,
-          HintSeg* tSeg)
+AddHValue(ValCands* cands, const ValKey* keys, int32_t numKeys, Fixed bot,
+          Fixed top, Fixed val, Fixed spc, HintSeg* bSeg, HintSeg* tSeg)
 {
     bool ghst;
     if (val == 0)
@@ -430,7 +495,10 @@ AddHValue(Fixed bot, Fixed top, Fixed val, Fixed spc, HintSeg* bSeg,
             !CheckBBoxes(bSeg->sElt, tSeg->sElt))
             return;
     }
-    InsertHValue(bot, top, val, spc, bSeg, tSeg, ghst);
+    if (ghst &&
+        PruneGhostHValue(cands, keys, numKeys, bot, top, val, bSeg, tSeg))
+        return;
+    InsertHValue(cands, bot, top, val, spc, bSeg, tSeg, ghst);
 }
 
 static float
@@ -495,55 +563,165 @@ CombineValues(void)
     }
 }
 
+/* Segments of one list sorted by location, with their position in the list
+ * so that pairs can still be evaluated in list order. */
+typedef struct {
+    Fixed loc;
+    int32_t idx;
+    HintSeg* seg;
+} SegRef;
+
+static int
+CompareSegRefLoc(const void* a, const void* b)
+{
+    const SegRef* ra = a;
+    const SegRef* rb = b;
+    if (ra->loc != rb->loc)
+        return ra->loc < rb->loc ? -1 : 1;
+    return ra->idx < rb->idx ? -1 : ra->idx > rb->idx;
+}
+
+static int
+CompareSegRefIdx(const void* a, const void* b)
+{
+    const SegRef* ra = a;
+    const SegRef* rb = b;
+    return ra->idx < rb->idx ? -1 : ra->idx > rb->idx;
+}
+
+static SegRef*
+SortSegs(HintSeg* lst, int32_t* pcnt)
+{
+    HintSeg* seg;
+    SegRef* refs;
+    int32_t cnt = 0;
+    for (seg = lst; seg != NULL; seg = seg->sNxt)
+        cnt++;
+    *pcnt = cnt;
+    if (cnt == 0)
+        return NULL;
+    refs = (SegRef*)Alloc(cnt * sizeof(SegRef));
+    for (seg = lst, cnt = 0; seg != NULL; seg = seg->sNxt, cnt++) {
+        refs[cnt].loc = seg->sLoc;
+        refs[cnt].idx = cnt;
+        refs[cnt].seg = seg;
+    }
+    qsort(refs, cnt, sizeof(SegRef), CompareSegRefLoc);
+    return refs;
+}
+
+/* Index of the first entry located at or after loc. */
+static int32_t
+FirstSegAt(SegRef* refs, int32_t cnt, Fixed loc)
+{
+    int32_t lo = 0, hi = cnt;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (refs[mid].loc < loc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Copies the entries in [first, last) to window in list order. */
+static int32_t
+WindowSegs(SegRef* refs, int32_t first, int32_t last, SegRef* window)
+{
+    int32_t cnt = last - first;
+    if (cnt <= 0)
+        return 0;
+    memcpy(window, refs + first, cnt * sizeof(SegRef));
+    if (cnt > 1)
+        qsort(window, cnt, sizeof(SegRef), CompareSegRefIdx);
+    return cnt;
+}
+
+/* Largest distance between a pair of segments that can still matter. At
+ * twice the big distance AdjustVal gives a zero value, so only a stem near
+ * miss could be reported, and those are at most 2 units wider than the
+ * widest stem. */
+static Fixed
+MaxPairDist(Fixed bigDist, Fixed* stems, int32_t numStems)
+{
+    Fixed dist = 2 * bigDist - 1;
+    int32_t i;
+    for (i = 0; i < numStems; i++)
+        dist = NUMMAX(dist, abs(stems[i]) + FixInt(2));
+    return dist;
+}
+
 void
 EvalV(void)
 {
-    HintSeg *lList, *rList;
-    Fixed lft, rght;
+    HintSeg* lList;
+    SegRef *rRefs, *window;
+    ValCands cands = { NULL, 0, 0 };
+    int32_t i, rCnt, wCnt;
+    Fixed lft, rght, maxDist;
     Fixed val, spc;
-    gValList = NULL;
-    lList = leftList;
-    while (lList != NULL) {
-        rList = rightList;
-        while (rList != NULL) {
+    /* Pairs are only looked at within maxDist of each other; for each left
+     * segment the right ones are still visited in list order, so the
+     * values and reports come out in the same order as with a full scan. */
+    rRefs = SortSegs(rightList, &rCnt);
+    if (rCnt > 0) {
+        window = (SegRef*)Alloc(rCnt * sizeof(SegRef));
+        maxDist = MaxPairDist(gVBigDist, gVStems, gNumVStems);
+        lList = leftList;
+        while (lList != NULL) {
             lft = lList->sLoc;
-            rght = rList->sLoc;
-            if (lft < rght) {
+            wCnt = WindowSegs(rRefs, FirstSegAt(rRefs, rCnt, lft + 1),
+                              FirstSegAt(rRefs, rCnt, lft + maxDist + 1),
+                              window);
+            for (i = 0; i < wCnt; i++) {
+                HintSeg* rList = window[i].seg;
+                rght = rList->sLoc;
                 EvalVPair(lList, rList, &spc, &val);
                 VStemMiss(lList, rList);
-                AddVValue(lft, rght, val, spc, lList, rList);
+                AddVValue(&cands, lft, rght, val, spc, lList, rList);
             }
-            rList = rList->sNxt;
+            lList = lList->sNxt;
         }
-        lList = lList->sNxt;
     }
+    LinkValCands(&cands, false);
     CombineValues();
 }
 
 void
 EvalH(void)
 {
-    HintSeg *bList, *tList, *lst, *ghostSeg;
-    Fixed lstLoc, tempLoc, cntr;
+    HintSeg *bList, *lst, *ghostSeg;
+    SegRef *tRefs, *window;
+    ValCands cands = { NULL, 0, 0 };
+    ValKey* keys;
+    int32_t i, tCnt, wCnt, numKeys;
+    Fixed lstLoc, tempLoc, cntr, maxDist;
     Fixed val, spc;
-    gValList = NULL;
-    bList = botList;
-    while (bList != NULL) {
-        tList = topList;
-        while (tList != NULL) {
+    /* Same windowed sweep as in EvalV. */
+    tRefs = SortSegs(topList, &tCnt);
+    if (tCnt > 0) {
+        window = (SegRef*)Alloc(tCnt * sizeof(SegRef));
+        maxDist = MaxPairDist(gHBigDist, gHStems, gNumHStems);
+        bList = botList;
+        while (bList != NULL) {
             Fixed bot, top;
             bot = bList->sLoc;
-            top = tList->sLoc;
-            if (bot > top) {
+            wCnt = WindowSegs(tRefs, FirstSegAt(tRefs, tCnt, bot - maxDist),
+                              FirstSegAt(tRefs, tCnt, bot), window);
+            for (i = 0; i < wCnt; i++) {
+                HintSeg* tList = window[i].seg;
+                top = tList->sLoc;
                 EvalHPair(bList, tList, &spc, &val);
                 HStemMiss(bList, tList);
-                AddHValue(bot, top, val, spc, bList, tList);
+                AddHValue(&cands, NULL, 0, bot, top, val, spc, bList, tList);
             }
-            tList = tList->sNxt;
+            bList = bList->sNxt;
         }
-        bList = bList->sNxt;
     }
-    ghostSeg = (HintSeg*)Alloc(sizeof(HintSeg));
+    keys = SortValCands(&cands, true);
+    numKeys = cands.cnt;
+    ghostSeg = NewHintSeg();
     ghostSeg->sType = sGHOST;
     ghostSeg->sElt = NULL;
     if (gLenBotBands < 2 && gLenTopBands < 2)
@@ -561,7 +739,8 @@ EvalH(void)
             DEBUG_ROUND(ghostSeg->sMin) /* DEBUG 8 BIT */
             spc = FixInt(2);
             val = FixInt(20);
-            AddHValue(lstLoc, tempLoc, val, spc, lst, ghostSeg);
+            AddHValue(&cands, keys, numKeys, lstLoc, tempLoc, val, spc, lst,
+                      ghostSeg);
         }
         lst = lst->sNxt;
     }
@@ -576,10 +755,12 @@ EvalH(void)
             ghostSeg->sMin = cntr - gGhostLength / 2;
             spc = FixInt(2);
             val = FixInt(20);
-            AddHValue(tempLoc, lstLoc, val, spc, ghostSeg, lst);
+            AddHValue(&cands, keys, numKeys, tempLoc, lstLoc, val, spc,
+                      ghostSeg, lst);
         }
         lst = lst->sNxt;
     }
 done:
+    LinkValCands(&cands, true);
     CombineValues();
 }
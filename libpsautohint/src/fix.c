@@ -9,7 +9,8 @@
 
 #include "ac.h"
 
-static Fixed bPrev, tPrev;
+#define bPrev (gContext->bPrev)
+#define tPrev (gContext->tPrev)
 
 void
 InitFix(int32_t reason)
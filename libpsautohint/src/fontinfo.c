@@ -12,21 +12,42 @@
 
 #define UNDEFINED (INT32_MAX)
 
-int32_t gNumHHints, gNumVHints;
-
-static void ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
-                          int32_t maxstems, int* stems, int32_t* pnum);
+static bool ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
+                          int32_t maxstems, int* stems, int32_t* pnum,
+                          bool report);
 
 static char* GetFontInfo(const ACFontInfo*, char*, bool);
 
-static void
-ParseStems(const ACFontInfo* fontinfo, char* kw, Fixed* stems, int32_t* pnum)
+static bool
+ParseStems(const ACFontInfo* fontinfo, char* kw, Fixed* stems, int32_t* pnum,
+           bool report)
 {
     int istems[MAXSTEMS], i;
     memset(istems, 0, MAXSTEMS * sizeof(int));
-    ParseIntStems(fontinfo, kw, OPTIONAL, MAXSTEMS, istems, pnum);
+    if (!ParseIntStems(fontinfo, kw, OPTIONAL, MAXSTEMS, istems, pnum, report))
+        return false;
     for (i = 0; i < *pnum; i++)
         stems[i] = FixInt(istems[i]);
+    return true;
+}
+
+/* Returns false if the stems are invalid, after reporting it if report is
+ * true. */
+static bool
+ReadStems(const ACFontInfo* fontinfo, Fixed* hstems, int32_t* numhstems,
+          Fixed* vstems, int32_t* numvstems, bool report)
+{
+    /* check for FlexOK, AuxHStems, AuxVStems */
+    /* for intelligent scaling, it's too hard to check these */
+    if (!ParseStems(fontinfo, "StemSnapH", hstems, numhstems, report) ||
+        !ParseStems(fontinfo, "StemSnapV", vstems, numvstems, report))
+        return false;
+    if (*numhstems == 0) {
+        if (!ParseStems(fontinfo, "DominantH", hstems, numhstems, report) ||
+            !ParseStems(fontinfo, "DominantV", vstems, numvstems, report))
+            return false;
+    }
+    return true;
 }
 
 static void
@@ -49,8 +70,10 @@ GetKeyFixedValue(const ACFontInfo* fontinfo, char* keyword, bool optional,
         *value = FixInt(strtod(fontinfostr, NULL));
 }
 
-bool
-ReadFontInfo(const ACFontInfo* fontinfo)
+/* Decodes the font info values used for hinting, so that this is only done
+ * once per font info and not for every glyph. */
+static void
+PrepareFontInfo(ACFontInfo* fontinfo)
 {
     char* fontinfostr;
     int32_t AscenderHeight, AscenderOvershoot, BaselineYCoord,
@@ -60,6 +83,9 @@ ReadFontInfo(const ACFontInfo* fontinfo)
       Height6, Height6Overshoot, LcHeight, LcOvershoot, OrdinalBaseline,
       OrdinalOvershoot, SuperiorBaseline, SuperiorOvershoot;
     bool ORDINARYHINTING = gWriteHintedBez;
+    Fixed* botBands = fontinfo->botBands;
+    Fixed* topBands = fontinfo->topBands;
+    int32_t lenBotBands = 0, lenTopBands = 0;
 
     AscenderHeight = AscenderOvershoot = BaselineYCoord = BaselineOvershoot =
       Baseline5 = Baseline5Overshoot = Baseline6 = Baseline6Overshoot =
@@ -68,34 +94,28 @@ ReadFontInfo(const ACFontInfo* fontinfo)
             Height6Overshoot = LcHeight = LcOvershoot = OrdinalBaseline =
               OrdinalOvershoot = SuperiorBaseline = SuperiorOvershoot =
                 UNDEFINED; /* mark as undefined */
-    gNumHStems = gNumVStems = 0;
-    gNumHHints = gNumVHints = 0;
-    gLenBotBands = gLenTopBands = 0;
 
-    /* check for FlexOK, AuxHStems, AuxVStems */
-    /* for intelligent scaling, it's too hard to check these */
-    ParseStems(fontinfo, "StemSnapH", gHStems, &gNumHStems);
-    ParseStems(fontinfo, "StemSnapV", gVStems, &gNumVStems);
-    if (gNumHStems == 0) {
-        ParseStems(fontinfo, "DominantH", gHStems, &gNumHStems);
-        ParseStems(fontinfo, "DominantV", gVStems, &gNumVStems);
-    }
+    /* Errors in the stems are reported when hinting, see ReadFontInfo(). */
+    fontinfo->stemsOK =
+      ReadStems(fontinfo, fontinfo->hStems, &fontinfo->numHStems,
+                fontinfo->vStems, &fontinfo->numVStems, false);
+
     fontinfostr = GetFontInfo(fontinfo, "FlexOK", !ORDINARYHINTING);
-    gFlexOK = strcmp(fontinfostr, "false");
+    fontinfo->flexOK = strcmp(fontinfostr, "false");
 
     fontinfostr = GetFontInfo(fontinfo, "FlexStrict", true);
-    gFlexStrict = strcmp(fontinfostr, "false");
+    fontinfo->flexStrict = strcmp(fontinfostr, "false");
 
-    /* get bluefuzz. It is already set to its default value in ac.c::InitData().
-    GetKeyFixedValue does not change the value if it's not present in fontinfo.
-    */
-    GetKeyFixedValue(fontinfo, "BlueFuzz", OPTIONAL, &gBlueFuzz);
+    /* GetKeyFixedValue does not change the value if it's not present in
+     * fontinfo. */
+    fontinfo->blueFuzz = DEFAULTBLUEFUZZ;
+    GetKeyFixedValue(fontinfo, "BlueFuzz", OPTIONAL, &fontinfo->blueFuzz);
 
     /* Check for counter hinting glyphs. */
     fontinfostr = GetFontInfo(fontinfo, "VCounterChars", OPTIONAL);
-    gNumVHints = AddCounterHintGlyphs(fontinfostr, gVHintList);
+    AddCounterHintGlyphs(fontinfo, fontinfostr, VCOUNTERGLYPH);
     fontinfostr = GetFontInfo(fontinfo, "HCounterChars", OPTIONAL);
-    gNumHHints = AddCounterHintGlyphs(fontinfostr, gHHintList);
+    AddCounterHintGlyphs(fontinfo, fontinfostr, HCOUNTERGLYPH);
 
     GetKeyValue(fontinfo, "AscenderHeight", OPTIONAL, &AscenderHeight);
     GetKeyValue(fontinfo, "AscenderOvershoot", OPTIONAL, &AscenderOvershoot);
@@ -123,57 +143,88 @@ ReadFontInfo(const ACFontInfo* fontinfo)
     GetKeyValue(fontinfo, "SuperiorBaseline", OPTIONAL, &SuperiorBaseline);
     GetKeyValue(fontinfo, "SuperiorOvershoot", OPTIONAL, &SuperiorOvershoot);
 
-    gLenBotBands = gLenTopBands = 0;
     if (BaselineYCoord != UNDEFINED && BaselineOvershoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] = FixInt(BaselineYCoord + BaselineOvershoot);
-        gBotBands[gLenBotBands++] = FixInt(BaselineYCoord);
+        botBands[lenBotBands++] = FixInt(BaselineYCoord + BaselineOvershoot);
+        botBands[lenBotBands++] = FixInt(BaselineYCoord);
     }
     if (Baseline5 != UNDEFINED && Baseline5Overshoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] = FixInt(Baseline5 + Baseline5Overshoot);
-        gBotBands[gLenBotBands++] = FixInt(Baseline5);
+        botBands[lenBotBands++] = FixInt(Baseline5 + Baseline5Overshoot);
+        botBands[lenBotBands++] = FixInt(Baseline5);
     }
     if (Baseline6 != UNDEFINED && Baseline6Overshoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] = FixInt(Baseline6 + Baseline6Overshoot);
-        gBotBands[gLenBotBands++] = FixInt(Baseline6);
+        botBands[lenBotBands++] = FixInt(Baseline6 + Baseline6Overshoot);
+        botBands[lenBotBands++] = FixInt(Baseline6);
     }
     if (SuperiorBaseline != UNDEFINED && SuperiorOvershoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] =
-          FixInt(SuperiorBaseline + SuperiorOvershoot);
-        gBotBands[gLenBotBands++] = FixInt(SuperiorBaseline);
+        botBands[lenBotBands++] = FixInt(SuperiorBaseline + SuperiorOvershoot);
+        botBands[lenBotBands++] = FixInt(SuperiorBaseline);
     }
     if (OrdinalBaseline != UNDEFINED && OrdinalOvershoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] = FixInt(OrdinalBaseline + OrdinalOvershoot);
-        gBotBands[gLenBotBands++] = FixInt(OrdinalBaseline);
+        botBands[lenBotBands++] = FixInt(OrdinalBaseline + OrdinalOvershoot);
+        botBands[lenBotBands++] = FixInt(OrdinalBaseline);
     }
     if (DescenderHeight != UNDEFINED && DescenderOvershoot != UNDEFINED) {
-        gBotBands[gLenBotBands++] =
-          FixInt(DescenderHeight + DescenderOvershoot);
-        gBotBands[gLenBotBands++] = FixInt(DescenderHeight);
+        botBands[lenBotBands++] = FixInt(DescenderHeight + DescenderOvershoot);
+        botBands[lenBotBands++] = FixInt(DescenderHeight);
     }
     if (CapHeight != UNDEFINED && CapOvershoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(CapHeight);
-        gTopBands[gLenTopBands++] = FixInt(CapHeight + CapOvershoot);
+        topBands[lenTopBands++] = FixInt(CapHeight);
+        topBands[lenTopBands++] = FixInt(CapHeight + CapOvershoot);
     }
     if (LcHeight != UNDEFINED && LcOvershoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(LcHeight);
-        gTopBands[gLenTopBands++] = FixInt(LcHeight + LcOvershoot);
+        topBands[lenTopBands++] = FixInt(LcHeight);
+        topBands[lenTopBands++] = FixInt(LcHeight + LcOvershoot);
     }
     if (AscenderHeight != UNDEFINED && AscenderOvershoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(AscenderHeight);
-        gTopBands[gLenTopBands++] = FixInt(AscenderHeight + AscenderOvershoot);
+        topBands[lenTopBands++] = FixInt(AscenderHeight);
+        topBands[lenTopBands++] = FixInt(AscenderHeight + AscenderOvershoot);
     }
     if (FigHeight != UNDEFINED && FigOvershoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(FigHeight);
-        gTopBands[gLenTopBands++] = FixInt(FigHeight + FigOvershoot);
+        topBands[lenTopBands++] = FixInt(FigHeight);
+        topBands[lenTopBands++] = FixInt(FigHeight + FigOvershoot);
     }
     if (Height5 != UNDEFINED && Height5Overshoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(Height5);
-        gTopBands[gLenTopBands++] = FixInt(Height5 + Height5Overshoot);
+        topBands[lenTopBands++] = FixInt(Height5);
+        topBands[lenTopBands++] = FixInt(Height5 + Height5Overshoot);
     }
     if (Height6 != UNDEFINED && Height6Overshoot != UNDEFINED) {
-        gTopBands[gLenTopBands++] = FixInt(Height6);
-        gTopBands[gLenTopBands++] = FixInt(Height6 + Height6Overshoot);
+        topBands[lenTopBands++] = FixInt(Height6);
+        topBands[lenTopBands++] = FixInt(Height6 + Height6Overshoot);
+    }
+    fontinfo->lenBotBands = lenBotBands;
+    fontinfo->lenTopBands = lenTopBands;
+}
+
+/* Sets up the hinting state from the decoded font info. */
+bool
+ReadFontInfo(const ACFontInfo* fontinfo)
+{
+    if (!fontinfo) {
+        LogMsg(LOGERROR, NONFATALERROR, "Fontinfo is NULL");
+        return false;
+    }
+
+    if (fontinfo->stemsOK) {
+        memcpy(gHStems, fontinfo->hStems, sizeof(gHStems));
+        memcpy(gVStems, fontinfo->vStems, sizeof(gVStems));
+        gNumHStems = fontinfo->numHStems;
+        gNumVStems = fontinfo->numVStems;
+    } else if (!ReadStems(fontinfo, gHStems, &gNumHStems, gVStems,
+                          &gNumVStems, true)) {
+        return false;
     }
+
+    gFlexOK = fontinfo->flexOK;
+    gFlexStrict = fontinfo->flexStrict;
+    gBlueFuzz = fontinfo->blueFuzz;
+
+    gGlyphNames = &fontinfo->glyphNames;
+
+    memcpy(gBotBands, fontinfo->botBands, sizeof(gBotBands));
+    memcpy(gTopBands, fontinfo->topBands, sizeof(gTopBands));
+    gLenBotBands = fontinfo->lenBotBands;
+    gLenTopBands = fontinfo->lenTopBands;
+
     return true;
 }
 
@@ -223,9 +274,9 @@ GetFontInfo(const ACFontInfo* fontinfo, char* keyword, bool optional)
  * StemSnap{H,V}, Dominant{H,V}.
  * ParseIntStems guarantees that stem values are unique and in ascending order.
  */
-static void
+static bool
 ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
-              int32_t maxstems, int* stems, int32_t* pnum)
+              int32_t maxstems, int* stems, int32_t* pnum, bool report)
 {
     int i, j, count = 0;
     bool singleint = false;
@@ -236,7 +287,7 @@ ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
 
     initline = GetFontInfo(fontinfo, kw, optional);
     if (strlen(initline) == 0)
-        return; /* optional keyword not found */
+        return true; /* optional keyword not found */
 
     line = initline;
 
@@ -255,14 +306,19 @@ ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
             break;
 
         if (count >= maxstems) {
-            LogMsg(LOGERROR, NONFATALERROR,
-                   "Cannot have more than %d values in fontinfo array: %s",
-                   (int)maxstems, initline);
+            if (report)
+                LogMsg(LOGERROR, NONFATALERROR,
+                       "Cannot have more than %d values in fontinfo array: %s",
+                       (int)maxstems, initline);
+            return false;
         }
 
         if (val < 1) {
-            LogMsg(LOGERROR, NONFATALERROR,
-                   "Cannot have a value < 1 in fontinfo file array: %s", line);
+            if (report)
+                LogMsg(LOGERROR, NONFATALERROR,
+                       "Cannot have a value < 1 in fontinfo file array: %s",
+                       line);
+            return false;
         }
 
         stems[count++] = val;
@@ -296,6 +352,7 @@ ParseIntStems(const ACFontInfo* fontinfo, char* kw, bool optional,
     }
 
     *pnum = count;
+    return true;
 }
 
 void
@@ -306,6 +363,8 @@ FreeFontInfo(ACFontInfo* fontinfo)
     if (!fontinfo)
         return;
 
+    FreeGlyphNameSet(fontinfo);
+
     if(fontinfo->values) {
         for (i = 0; i < fontinfo->length; i++) {
             if (fontinfo->values[i][0]) {
@@ -344,15 +403,22 @@ NewFontInfo(void)
     ACFontInfo* fontinfo;
 
     fontinfo = (ACFontInfo*)AllocateMem(1, sizeof(ACFontInfo), "fontinfo");
+    if (fontinfo == NULL)
+        return NULL;
     fontinfo->length = 0;
     while (fontinfo_keys[fontinfo->length] != NULL)
         fontinfo->length++;
     fontinfo->values =
       (char**)AllocateMem(fontinfo->length, sizeof(char*), "fontinfo values");
+    if (fontinfo->values == NULL) {
+        UnallocateMem(fontinfo);
+        return NULL;
+    }
 
     fontinfo->keys = fontinfo_keys;
     for (i = 0; i < fontinfo->length; i++)
         fontinfo->values[i] = "";
+    InitGlyphNameSet(fontinfo);
 
     return fontinfo;
 }
@@ -395,8 +461,12 @@ ParseFontInfo(const char* data)
 
     ACFontInfo* info = NewFontInfo();
 
-    if (!data)
+    if (!info)
+        return NULL;
+    if (!data) {
+        PrepareFontInfo(info);
         return info;
+    }
 
     current = data;
     while (*current) {
@@ -426,6 +496,11 @@ ParseFontInfo(const char* data)
             if (!strncmp(info->keys[i], kwstart, matchLen)) {
                 info->values[i] =
                   AllocateMem(current - tkstart + 1, 1, "fontinfo entry value");
+                if (info->values[i] == NULL) {
+                    info->values[i] = "";
+                    FreeFontInfo(info);
+                    return NULL;
+                }
                 strncpy(info->values[i], tkstart, current - tkstart);
                 info->values[i][current - tkstart] = '\0';
                 break;
@@ -434,5 +509,6 @@ ParseFontInfo(const char* data)
         skipblanks();
     }
 
+    PrepareFontInfo(info);
     return info;
 }
@@ -12,8 +12,10 @@
 #include "ac.h"
 #include "bbox.h"
 
-static SegLnkLst *Hlnks, *Vlnks;
-static int32_t cpFrom, cpTo;
+#define Hlnks (gContext->hlnks)
+#define Vlnks (gContext->vlnks)
+#define cpFrom (gContext->cpFrom)
+#define cpTo (gContext->cpTo)
 
 void
 InitGen(int32_t reason)
@@ -33,10 +35,10 @@ LinkSegment(PathElt* e, bool Hflg, HintSeg* seg)
 {
     SegLnk* newlnk;
     SegLnkLst *newlst, *globlst;
-    newlnk = (SegLnk*)Alloc(sizeof(SegLnk));
+    newlnk = NewSegLnk();
     newlnk->seg = seg;
-    newlst = (SegLnkLst*)Alloc(sizeof(SegLnkLst));
-    globlst = (SegLnkLst*)Alloc(sizeof(SegLnkLst));
+    newlst = NewSegLnkLst();
+    globlst = NewSegLnkLst();
     globlst->lnk = newlnk;
     newlst->lnk = newlnk;
     if (Hflg) {
@@ -57,7 +59,7 @@ CopySegmentLink(PathElt* e1, PathElt* e2, bool Hflg)
 {
     /* copy reference to first link from e1 to e2 */
     SegLnkLst* newlst;
-    newlst = (SegLnkLst*)Alloc(sizeof(SegLnkLst));
+    newlst = NewSegLnkLst();
     if (Hflg) {
         newlst->lnk = e1->Hs->lnk;
         newlst->next = e2->Hs;
@@ -75,7 +77,8 @@ AddSegment(Fixed from, Fixed to, Fixed loc, int32_t lftLstNm, int32_t rghtLstNm,
 {
     HintSeg *seg, *segList, *prevSeg;
     int32_t segNm;
-    seg = (HintSeg*)Alloc(sizeof(HintSeg));
+    seg = NewHintSeg();
+    CountStat(segments, 1);
     seg->sLoc = loc;
     if (from > to) {
         seg->sMax = from;
@@ -404,11 +407,20 @@ RemExtraBends(int32_t l0, int32_t l1)
 {
     HintSeg* lst0 = gSegLists[l0];
     HintSeg* prv = NULL;
+    /* Both lists are in increasing order by sLoc, so the segments of l1
+     * before the current loc0 are never looked at again. start is the last
+     * of them; it is never deleted, as only segments at loc0 are. */
+    HintSeg* start = NULL;
     while (lst0 != NULL) {
         HintSeg* nxt = lst0->sNxt;
         Fixed loc0 = lst0->sLoc;
-        HintSeg* lst = gSegLists[l1];
-        HintSeg* p = NULL;
+        HintSeg* lst = (start == NULL) ? gSegLists[l1] : start->sNxt;
+        HintSeg* p = start;
+        while (lst != NULL && lst->sLoc < loc0) {
+            p = lst;
+            lst = lst->sNxt;
+        }
+        start = p;
         while (lst != NULL) {
             HintSeg* n = lst->sNxt;
             Fixed loc = lst->sLoc;
@@ -448,56 +460,145 @@ RemExtraBends(int32_t l0, int32_t l1)
     }
 }
 
+/* Extents of the segments of a run with the same sLoc, kept in a tree over
+ * their positions in the list so that the first later segment overlapping
+ * a given one is found without scanning the run. Merged away segments get
+ * an empty extent. */
+typedef struct {
+    HintSeg** segs;
+    Fixed *mn, *mx;
+    int32_t size;
+} SegTree;
+
+static void
+SetSegTreeLeaf(SegTree* tree, int32_t i, Fixed mn, Fixed mx)
+{
+    i += tree->size;
+    tree->mn[i] = mn;
+    tree->mx[i] = mx;
+    for (i /= 2; i > 0; i /= 2) {
+        tree->mn[i] = NUMMIN(tree->mn[2 * i], tree->mn[2 * i + 1]);
+        tree->mx[i] = NUMMAX(tree->mx[2 * i], tree->mx[2 * i + 1]);
+    }
+}
+
+/* First position from `from` on, within node (covering lo..hi), whose
+ * segment overlaps mn..mx, or -1. */
+static int32_t
+FirstOverlapSeg(SegTree* tree, int32_t node, int32_t lo, int32_t hi,
+                int32_t from, Fixed mn, Fixed mx)
+{
+    int32_t mid, i;
+    if (hi < from || tree->mn[node] > mx || tree->mx[node] < mn)
+        return -1;
+    if (lo == hi)
+        return lo;
+    mid = (lo + hi) / 2;
+    i = FirstOverlapSeg(tree, 2 * node, lo, mid, from, mn, mx);
+    if (i < 0)
+        i = FirstOverlapSeg(tree, 2 * node + 1, mid + 1, hi, from, mn, mx);
+    return i;
+}
+
+/* Merges the overlapping segments of the cnt segments from first on, which
+ * all have the same sLoc, and returns the ones left in list order. Each
+ * segment is merged with the first later one it overlaps until there is
+ * none; the longer of the two is kept, the later one on a tie. */
+static HintSeg*
+CompactRun(HintSeg* first, int32_t cnt, void (*nm)(HintSeg*, HintSeg*))
+{
+    SegTree tree;
+    HintSeg *seg, *head = NULL, *tail = NULL, *after;
+    int32_t i, j;
+    tree.size = 1;
+    while (tree.size < cnt)
+        tree.size *= 2;
+    tree.segs = (HintSeg**)Alloc(cnt * sizeof(HintSeg*));
+    tree.mn = (Fixed*)Alloc(2 * tree.size * sizeof(Fixed));
+    tree.mx = (Fixed*)Alloc(2 * tree.size * sizeof(Fixed));
+    for (i = 0; i < 2 * tree.size; i++) {
+        tree.mn[i] = FIXED_MAX;
+        tree.mx[i] = FIXED_MIN;
+    }
+    for (i = 0, seg = first; i < cnt; i++, seg = seg->sNxt) {
+        tree.segs[i] = seg;
+        SetSegTreeLeaf(&tree, i, seg->sMin, seg->sMax);
+    }
+    after = seg;
+
+    i = 0;
+    while (i < cnt) {
+        HintSeg* lst = tree.segs[i];
+        HintSeg* nxt;
+        Fixed lstmin, lstmax, nxtmin, nxtmax;
+        if (lst == NULL) {
+            i++;
+            continue;
+        }
+        lstmin = lst->sMin;
+        lstmax = lst->sMax;
+        j = FirstOverlapSeg(&tree, 1, 0, tree.size - 1, i + 1, lstmin,
+                            lstmax);
+        if (j < 0) {
+            if (tail == NULL)
+                head = lst;
+            else
+                tail->sNxt = lst;
+            tail = lst;
+            i++;
+            continue;
+        }
+        nxt = tree.segs[j];
+        nxtmin = nxt->sMin;
+        nxtmax = nxt->sMax;
+        /* do not worry about YgoesUp since "sMax" is really max in
+         device space, not in glyph space */
+        if (abs(lstmax - lstmin) > abs(nxtmax - nxtmin)) {
+            /* merge into lst and remove nxt */
+            (*nm)(nxt, lst);
+            lst->sMin = NUMMIN(lstmin, nxtmin);
+            lst->sMax = NUMMAX(lstmax, nxtmax);
+            lst->sBonus = NUMMAX(lst->sBonus, nxt->sBonus);
+            tree.segs[j] = NULL;
+            SetSegTreeLeaf(&tree, j, FIXED_MAX, FIXED_MIN);
+        } else { /* merge into nxt and remove lst */
+            (*nm)(lst, nxt);
+            nxt->sMin = NUMMIN(lstmin, nxtmin);
+            nxt->sMax = NUMMAX(lstmax, nxtmax);
+            nxt->sBonus = NUMMAX(lst->sBonus, nxt->sBonus);
+            SetSegTreeLeaf(&tree, j, nxt->sMin, nxt->sMax);
+            i++;
+        }
+    }
+    tail->sNxt = after;
+    return head;
+}
+
 static void
 CompactList(int32_t i, void (*nm)(HintSeg*, HintSeg*))
 {
+    /* The list is in increasing order by sLoc and only segments with the
+     * same sLoc are merged, so each run of those is compacted on its own. */
     HintSeg* lst = gSegLists[i];
     HintSeg* prv = NULL;
     while (lst != NULL) {
-        bool flg;
         HintSeg* nxt = lst->sNxt;
-        HintSeg* nxtprv = lst;
-        while (true) {
-            Fixed lstmin, lstmax, nxtmin, nxtmax;
-            if ((nxt == NULL) || (nxt->sLoc > lst->sLoc)) {
-                flg = true;
-                break;
-            }
-            lstmin = lst->sMin;
-            lstmax = lst->sMax;
-            nxtmin = nxt->sMin;
-            nxtmax = nxt->sMax;
-            if (lstmax >= nxtmin && lstmin <= nxtmax) {
-                /* do not worry about YgoesUp since "sMax" is really max in
-                 device space, not in glyph space */
-                if (abs(lstmax - lstmin) > abs(nxtmax - nxtmin)) {
-                    /* merge into lst and remove nxt */
-                    (*nm)(nxt, lst);
-                    lst->sMin = NUMMIN(lstmin, nxtmin);
-                    lst->sMax = NUMMAX(lstmax, nxtmax);
-                    lst->sBonus = NUMMAX(lst->sBonus, nxt->sBonus);
-                    nxtprv->sNxt = nxt->sNxt;
-                } else { /* merge into nxt and remove lst */
-                    (*nm)(lst, nxt);
-                    nxt->sMin = NUMMIN(lstmin, nxtmin);
-                    nxt->sMax = NUMMAX(lstmax, nxtmax);
-                    nxt->sBonus = NUMMAX(lst->sBonus, nxt->sBonus);
-                    lst = lst->sNxt;
-                    if (prv == NULL)
-                        gSegLists[i] = lst;
-                    else
-                        prv->sNxt = lst;
-                }
-                flg = false;
-                break;
-            }
-            nxtprv = nxt;
+        int32_t cnt = 1;
+        while (nxt != NULL && nxt->sLoc == lst->sLoc) {
             nxt = nxt->sNxt;
+            cnt++;
         }
-        if (flg) {
-            prv = lst;
-            lst = lst->sNxt;
+        if (cnt > 1) {
+            lst = CompactRun(lst, cnt, nm);
+            if (prv == NULL)
+                gSegLists[i] = lst;
+            else
+                prv->sNxt = lst;
+            while (lst->sNxt != nxt)
+                lst = lst->sNxt;
         }
+        prv = lst;
+        lst = nxt;
     }
 }
 
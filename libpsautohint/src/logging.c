@@ -11,15 +11,12 @@
 
 #include "ac.h"
 
-AC_REPORTFUNCPTR gLibReportCB = NULL;
-
-/* proc to be called from LogMsg if error occurs */
-static int (*errorproc)(int16_t);
-
+/* Sets the proc to be called from LogMsg if error occurs. It is kept in the
+ * current context, so each call into the library has its own. */
 void
 set_errorproc(int (*userproc)(int16_t))
 {
-    errorproc = userproc;
+    gContext->errorproc = userproc;
 }
 
 void
@@ -28,21 +25,24 @@ LogMsg(int16_t level, /* error, warning, info */
        char* format,  /* message string */
        ...)
 {
-    /* "glyphname: message" */
-    char str[MAX_GLYPHNAME_LEN + 2 + MAXMSGLEN + 1] = { 0 };
-    va_list va;
+    /* The message is only formatted if it is going to be reported. */
+    if (LogEnabled(level)) {
+        /* "glyphname: message" */
+        char str[MAX_GLYPHNAME_LEN + 2 + MAXMSGLEN + 1] = { 0 };
+        va_list va;
 
-    if (strlen(gGlyphName) > 0)
-        snprintf(str, strlen(gGlyphName) + 3, "%s: ", gGlyphName);
+        if (gContext != NULL && strlen(gGlyphName) > 0)
+            snprintf(str, strlen(gGlyphName) + 3, "%s: ", gGlyphName);
 
-    va_start(va, format);
-    vsnprintf(str + strlen(str), MAXMSGLEN, format, va);
-    va_end(va);
+        va_start(va, format);
+        vsnprintf(str + strlen(str), MAXMSGLEN, format, va);
+        va_end(va);
 
-    if (gLibReportCB != NULL)
         gLibReportCB(str, level);
+    }
 
-    if (level == LOGERROR && (code == NONFATALERROR || code == FATALERROR)) {
-        (*errorproc)(code);
+    if (level == LOGERROR && (code == NONFATALERROR || code == FATALERROR) &&
+        gContext != NULL && gContext->errorproc != NULL) {
+        (*gContext->errorproc)(code);
     }
 }
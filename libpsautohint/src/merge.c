@@ -106,10 +106,11 @@ PruneOne(HintVal* sLst, bool hFlg, HintVal* sL, int32_t i)
 {
     /* Simply set the 'pruned' field to True for sLst. */
     if (hFlg)
-        ReportPruneHVal(sLst, sL, i);
+        DebugReport(ReportPruneHVal(sLst, sL, i));
     else
-        ReportPruneVVal(sLst, sL, i);
+        DebugReport(ReportPruneVVal(sLst, sL, i));
     sLst->pruned = true;
+    CountStat(prunedValues, 1);
     return sLst->vNxt;
 }
 
@@ -158,6 +159,128 @@ PruneVeryMuchGt(Fixed val, Fixed v)
     return (v / VERYMUCHFCTR) > val;
 }
 
+/* The values of gValList in list order and sorted by their other location,
+ * with their positions in the list. The pruning loops only look at the
+ * values that can prune the one at hand, but still in list order, since the
+ * first one found decides and otherLft/otherRht and otherBot/otherTop build
+ * up in that order. Those are the values with their main location (vLoc1
+ * for V values, vLoc2 for H values) in a band, which are next to each other
+ * as EvalV and EvalH sort the list by it, and the few with their other
+ * location near a given one. */
+typedef struct {
+    Fixed loc;
+    int32_t pos;
+    HintVal* val;
+} ValRef;
+
+typedef struct {
+    ValRef *list, *byOther, *near;
+    int32_t cnt;
+    bool sorted; /* false if the list is not sorted by the main location */
+    int32_t m, mStart, mEnd, n, nEnd; /* the walk in progress */
+} PruneIndex;
+
+static int
+CompareValRefLoc(const void* a, const void* b)
+{
+    const ValRef* ra = a;
+    const ValRef* rb = b;
+    if (ra->loc != rb->loc)
+        return ra->loc < rb->loc ? -1 : 1;
+    return ra->pos < rb->pos ? -1 : ra->pos > rb->pos;
+}
+
+static int
+CompareValRefPos(const void* a, const void* b)
+{
+    const ValRef* ra = a;
+    const ValRef* rb = b;
+    return ra->pos < rb->pos ? -1 : ra->pos > rb->pos;
+}
+
+static void
+InitPruneIndex(PruneIndex* idx, bool mainLoc1)
+{
+    HintVal* vL;
+    int32_t cnt = 0;
+    for (vL = gValList; vL != NULL; vL = vL->vNxt)
+        cnt++;
+    idx->cnt = cnt;
+    idx->sorted = true;
+    if (cnt == 0)
+        return;
+    idx->list = (ValRef*)Alloc(cnt * sizeof(ValRef));
+    idx->byOther = (ValRef*)Alloc(cnt * sizeof(ValRef));
+    idx->near = (ValRef*)Alloc(cnt * sizeof(ValRef));
+    for (vL = gValList, cnt = 0; vL != NULL; vL = vL->vNxt, cnt++) {
+        idx->list[cnt].loc = mainLoc1 ? vL->vLoc1 : vL->vLoc2;
+        idx->byOther[cnt].loc = mainLoc1 ? vL->vLoc2 : vL->vLoc1;
+        idx->list[cnt].pos = idx->byOther[cnt].pos = cnt;
+        idx->list[cnt].val = idx->byOther[cnt].val = vL;
+        if (cnt > 0 && idx->list[cnt].loc < idx->list[cnt - 1].loc)
+            idx->sorted = false;
+    }
+    qsort(idx->byOther, cnt, sizeof(ValRef), CompareValRefLoc);
+}
+
+/* Index of the first entry located at or after loc. */
+static int32_t
+FirstValAt(ValRef* refs, int32_t cnt, Fixed loc)
+{
+    int32_t lo = 0, hi = cnt;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (refs[mid].loc < loc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Starts a walk over the values with their main location in mainLo..mainHi
+ * or their other location less than a unit away from other. If the list
+ * is not sorted, all values are walked. */
+static void
+StartPruneWalk(PruneIndex* idx, Fixed mainLo, Fixed mainHi, Fixed other)
+{
+    int32_t i, first, last;
+    idx->n = idx->nEnd = 0;
+    if (!idx->sorted) {
+        idx->m = idx->mStart = 0;
+        idx->mEnd = idx->cnt;
+        return;
+    }
+    idx->m = idx->mStart = FirstValAt(idx->list, idx->cnt, mainLo);
+    idx->mEnd = FirstValAt(idx->list, idx->cnt, mainHi + 1);
+    first = FirstValAt(idx->byOther, idx->cnt, other - FixOne + 1);
+    last = FirstValAt(idx->byOther, idx->cnt, other + FixOne);
+    for (i = first; i < last; i++) {
+        ValRef* ref = &idx->byOther[i];
+        if (ref->pos < idx->mStart || ref->pos >= idx->mEnd)
+            idx->near[idx->nEnd++] = *ref;
+    }
+    /* they are in list order unless they have different locations */
+    for (i = 1; i < idx->nEnd; i++) {
+        if (idx->near[i].pos < idx->near[i - 1].pos) {
+            qsort(idx->near, idx->nEnd, sizeof(ValRef), CompareValRefPos);
+            break;
+        }
+    }
+}
+
+static HintVal*
+NextPruneVal(PruneIndex* idx)
+{
+    bool mLeft = idx->m < idx->mEnd;
+    bool nLeft = idx->n < idx->nEnd;
+    if (mLeft && (!nLeft || idx->m < idx->near[idx->n].pos))
+        return idx->list[idx->m++].val;
+    if (nLeft)
+        return idx->near[idx->n++].val;
+    return NULL;
+}
+
 /* The changes made here and in PruneHVals are to fix a bug in
  MinisterLight/E where the top left point was not getting hinted. */
 void
@@ -165,11 +288,13 @@ PruneVVals(void)
 {
     HintVal *sLst, *sL;
     HintSeg *seg1, *seg2, *sg1, *sg2;
+    PruneIndex idx;
     Fixed lft, rht, l, r, prndist;
     Fixed val, v;
     bool flg, otherLft, otherRht;
     sLst = gValList;
     prndist = PRNDIST;
+    InitPruneIndex(&idx, true);
     while (sLst != NULL) {
         flg = true;
         otherLft = otherRht = false;
@@ -178,15 +303,18 @@ PruneVVals(void)
         rht = sLst->vLoc2;
         seg1 = sLst->vSeg1;
         seg2 = sLst->vSeg2;
-        sL = gValList;
-        while (sL != NULL) {
+        /* Only values inside lft - prndist..rht + prndist (vLoc1 < vLoc2
+         * for all of them) or with a right edge within a unit of rht can
+         * prune this one. */
+        StartPruneWalk(&idx, lft - prndist, rht + prndist, rht);
+        while ((sL = NextPruneVal(&idx)) != NULL) {
             v = sL->vVal;
             sg1 = sL->vSeg1;
             sg2 = sL->vSeg2;
             l = sL->vLoc1;
             r = sL->vLoc2;
             if ((l == lft && r == rht) || PruneLe(val, v))
-                goto NxtSL;
+                continue;
             if (rht + prndist >= r && lft - prndist <= l &&
                 (val < FixInt(100) && PruneMuchGt(val, v)
                    ? (CloseSegs(seg1, sg1, true) || CloseSegs(seg2, sg2, true))
@@ -225,8 +353,6 @@ PruneVVals(void)
                     break;
                 }
             }
-        NxtSL:
-            sL = sL->vNxt;
         }
         if (flg) {
             sLst = sLst->vNxt;
@@ -241,11 +367,13 @@ PruneHVals(void)
 {
     HintVal *sLst, *sL;
     HintSeg *seg1, *seg2, *sg1, *sg2;
+    PruneIndex idx;
     Fixed bot, top, t, b;
     Fixed val, v, prndist;
     bool flg, otherTop, otherBot, topInBlue, botInBlue, ghst;
     sLst = gValList;
     prndist = PRNDIST;
+    InitPruneIndex(&idx, false);
     while (sLst != NULL) {
         flg = true;
         otherTop = otherBot = false;
@@ -257,16 +385,19 @@ PruneHVals(void)
         top = sLst->vLoc2;
         topInBlue = InBlueBand(top, gLenTopBands, gTopBands);
         botInBlue = InBlueBand(bot, gLenBotBands, gBotBands);
-        sL = gValList;
-        while (sL != NULL) {
+        /* Only values inside top - prndist..bot + prndist (vLoc2 < vLoc1
+         * for all of them) or with a bottom within a unit of bot can prune
+         * this one. */
+        StartPruneWalk(&idx, top - prndist, bot + prndist, bot);
+        while ((sL = NextPruneVal(&idx)) != NULL) {
             if ((sL->pruned) && (gDoAligns || !gDoStems))
-                goto NxtSL;
+                continue;
 
             sg1 = sL->vSeg1;
             sg2 = sL->vSeg2; /* sg1 is b, sg2 is t */
             v = sL->vVal;
             if (!ghst && sL->vGhst && !PruneVeryMuchGt(val, v))
-                goto NxtSL; /* Do not bother checking if we should prune, if
+                continue; /* Do not bother checking if we should prune, if
                                slSt is not ghost hint, sL is ghost hint,
                                          and not (sL->vVal is  more than 50*
                                bigger than sLst->vVal.
@@ -275,7 +406,7 @@ PruneHVals(void)
             b = sL->vLoc1;
             t = sL->vLoc2;
             if (t == top && b == bot)
-                goto NxtSL; /* Don't compare two valList elements that have the
+                continue; /* Don't compare two valList elements that have the
                                same top and bot. */
 
             if (/* Prune sLst if the following are all true */
@@ -309,7 +440,7 @@ PruneHVals(void)
             }
 
             if (seg1 == NULL || seg2 == NULL)
-                goto NxtSL; /* If the sLst is aghost hint, skip  */
+                continue; /* If the sLst is aghost hint, skip  */
 
             if (abs(b - bot) < FixOne) {
                 /* If the bottoms of the stems are within 1 unit */
@@ -356,8 +487,6 @@ PruneHVals(void)
                 flg = false;
                 break;
             }
-        NxtSL:
-            sL = sL->vNxt;
         }
         if (flg) {
             sLst = sLst->vNxt;
@@ -413,11 +542,11 @@ ReplaceVals(Fixed oldB, Fixed oldT, Fixed newB, Fixed newT, HintVal* newBst,
         if (vL->vLoc1 != oldB || vL->vLoc2 != oldT || vL->merge)
             continue;
         if (vert)
-            ReportMergeVVal(oldB, oldT, newB, newT, vL->vVal, vL->vSpc,
-                            newBst->vVal, newBst->vSpc);
+            DebugReport(ReportMergeVVal(oldB, oldT, newB, newT, vL->vVal,
+                                        vL->vSpc, newBst->vVal, newBst->vSpc));
         else
-            ReportMergeHVal(oldB, oldT, newB, newT, vL->vVal, vL->vSpc,
-                            newBst->vVal, newBst->vSpc);
+            DebugReport(ReportMergeHVal(oldB, oldT, newB, newT, vL->vVal,
+                                        vL->vSpc, newBst->vVal, newBst->vSpc));
         vL->vLoc1 = newB;
         vL->vLoc2 = newT;
         vL->vVal = newBst->vVal;
@@ -7,8 +7,33 @@
  * This license is available at: http://opensource.org/licenses/Apache-2.0.
  */
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
 #include "ac.h"
 
+/* A monotonic clock in nanoseconds, for the stats. */
+uint64_t
+NanoTime(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(count.QuadPart / freq.QuadPart * 1000000000 +
+                      count.QuadPart % freq.QuadPart * 1000000000 /
+                        freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
 int32_t
 CountSubPaths(void)
 {
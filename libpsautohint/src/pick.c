@@ -10,7 +10,8 @@
 #include "ac.h"
 #include "bbox.h"
 
-static HintVal *Vrejects, *Hrejects;
+#define Vrejects (gContext->vrejects)
+#define Hrejects (gContext->hrejects)
 
 void
 InitPick(int32_t reason)
@@ -182,7 +183,7 @@ FndBstVal(HintSeg* seg, bool seg1Flg, HintVal* cList, HintVal* rList,
             break;
         vList = rList;
     }
-    ReportFndBstVal(seg, best, hFlg);
+    DebugReport(ReportFndBstVal(seg, best, hFlg));
     return best;
 }
 
@@ -14,9 +14,8 @@
 #include "psautohint.h"
 #include "version.h"
 
-ACBuffer* gBezOutput = NULL;
-
-static jmp_buf aclibmark; /* to handle exit() calls in the library version*/
+/* used by AutoHintString() and AutoHintStringMM() */
+static ACContext* defaultContext = NULL;
 
 ACLIB_API void
 AC_SetMemManager(void* ctxptr, AC_MEMMANAGEFUNCPTR func)
@@ -24,46 +23,114 @@ AC_SetMemManager(void* ctxptr, AC_MEMMANAGEFUNCPTR func)
     setAC_memoryManager(ctxptr, func);
 }
 
+static void
+SetReportStems(ACCallbacks* cb, AC_REPORTSTEMPTR hstemCB,
+               AC_REPORTSTEMPTR vstemCB, unsigned int allStems, void* userData)
+{
+    cb->allStems = allStems;
+    cb->addHStem = hstemCB;
+    cb->addVStem = vstemCB;
+    cb->addStemUserData = userData;
+    cb->doStems = true;
+
+    cb->addGlyphExtremes = NULL;
+    cb->addStemExtremes = NULL;
+    cb->doAligns = false;
+}
+
+static void
+SetReportZones(ACCallbacks* cb, AC_REPORTZONEPTR glyphCB,
+               AC_REPORTZONEPTR stemCB, void* userData)
+{
+    cb->addGlyphExtremes = glyphCB;
+    cb->addStemExtremes = stemCB;
+    cb->addExtremesUserData = userData;
+    cb->doAligns = true;
+
+    cb->addHStem = NULL;
+    cb->addVStem = NULL;
+    cb->doStems = false;
+}
+
 ACLIB_API void
 AC_SetReportCB(AC_REPORTFUNCPTR reportCB)
 {
-    gLibReportCB = reportCB;
+    gDefaultCallbacks.report = reportCB;
+}
+
+ACLIB_API void
+AC_SetLogLevel(int level)
+{
+    gDefaultCallbacks.logLevel = level;
 }
 
 ACLIB_API void
 AC_SetReportStemsCB(AC_REPORTSTEMPTR hstemCB, AC_REPORTSTEMPTR vstemCB,
                     unsigned int allStems, void* userData)
 {
-    gAllStems = allStems;
-    gAddHStemCB = hstemCB;
-    gAddVStemCB = vstemCB;
-    gAddStemUserData = userData;
-    gDoStems = true;
-
-    gAddGlyphExtremesCB = NULL;
-    gAddStemExtremesCB = NULL;
-    gDoAligns = false;
+    SetReportStems(&gDefaultCallbacks, hstemCB, vstemCB, allStems, userData);
 }
 
 ACLIB_API void
 AC_SetReportZonesCB(AC_REPORTZONEPTR glyphCB, AC_REPORTZONEPTR stemCB,
                     void* userData)
 {
-    gAddGlyphExtremesCB = glyphCB;
-    gAddStemExtremesCB = stemCB;
-    gAddExtremesUserData = userData;
-    gDoAligns = true;
-
-    gAddHStemCB = NULL;
-    gAddVStemCB = NULL;
-    gDoStems = false;
+    SetReportZones(&gDefaultCallbacks, glyphCB, stemCB, userData);
 }
 
 ACLIB_API void
 AC_SetReportRetryCB(AC_RETRYPTR retryCB, void* userData)
 {
-    gReportRetryCB = retryCB;
-    gReportRetryUserData = userData;
+    gDefaultCallbacks.reportRetry = retryCB;
+    gDefaultCallbacks.reportRetryUserData = userData;
+}
+
+ACLIB_API void
+ACContextSetReportCB(ACContext* ctx, AC_REPORTFUNCPTR reportCB)
+{
+    if (ctx != NULL)
+        ctx->callbacks.report = reportCB;
+}
+
+ACLIB_API void
+ACContextSetLogLevel(ACContext* ctx, int level)
+{
+    if (ctx != NULL)
+        ctx->callbacks.logLevel = level;
+}
+
+ACLIB_API void
+ACContextSetReportStemsCB(ACContext* ctx, AC_REPORTSTEMPTR hstemCB,
+                          AC_REPORTSTEMPTR vstemCB, unsigned int allStems,
+                          void* userData)
+{
+    if (ctx != NULL)
+        SetReportStems(&ctx->callbacks, hstemCB, vstemCB, allStems, userData);
+}
+
+ACLIB_API void
+ACContextSetReportZonesCB(ACContext* ctx, AC_REPORTZONEPTR glyphCB,
+                          AC_REPORTZONEPTR stemCB, void* userData)
+{
+    if (ctx != NULL)
+        SetReportZones(&ctx->callbacks, glyphCB, stemCB, userData);
+}
+
+ACLIB_API void
+ACContextSetReportRetryCB(ACContext* ctx, AC_RETRYPTR retryCB,
+                          void* userData)
+{
+    if (ctx != NULL) {
+        ctx->callbacks.reportRetry = retryCB;
+        ctx->callbacks.reportRetryUserData = userData;
+    }
+}
+
+ACLIB_API void
+ACContextResetCallbacks(ACContext* ctx)
+{
+    if (ctx != NULL)
+        ctx->callbacks = gDefaultCallbacks;
 }
 
 /*
@@ -72,33 +139,154 @@ AC_SetReportRetryCB(AC_RETRYPTR retryCB, void* userData)
  * will transfer the control to the point where setjmp() is called below. So
  * effectively whenever LogMsg() is called for an error the execution of the
  * calling function will end and we will return back to AutoHintString().
+ *
+ * The recovery point lives on the stack of the current call and is reached
+ * through the current context, so an error in one thread never unwinds a call
+ * running on another one.
  */
 static int
 error_handler(int16_t code)
 {
     if (code == FATALERROR || code == NONFATALERROR)
-        longjmp(aclibmark, -1);
+        longjmp(*gContext->errorMark, -1);
     else
-        longjmp(aclibmark, 1);
+        longjmp(*gContext->errorMark, 1);
 
     return 0; /* we don't actually ever get here */
 }
 
+/* Detaches the finished call from its context and makes the context of the
+ * caller (if any) current again. */
+static int
+end_call(ACContext* saved, int status)
+{
+    gContext->errorMark = NULL;
+    gContext->errorproc = NULL;
+    gContext = saved;
+    return status;
+}
+
+ACLIB_API ACContext*
+ACContextNew(void)
+{
+    ACContext* ctx;
+
+    ctx = (ACContext*)AllocateMem(1, sizeof(ACContext), "hinting context");
+    if (ctx == NULL)
+        return NULL;
+
+    ctx->addHints = true;
+    ctx->callbacks = gDefaultCallbacks;
+
+    return ctx;
+}
+
+ACLIB_API void
+ACContextFree(ACContext* ctx)
+{
+    ACContext* saved = gContext;
+
+    if (ctx == NULL)
+        return;
+
+    gContext = ctx;
+    FreeVM();
+    gContext = saved;
+
+    UnallocateMem(ctx->pathSnap.elts);
+    UnallocateMem(ctx);
+}
+
+ACLIB_API ACHintResult*
+ACHintResultNew(void)
+{
+    return (ACHintResult*)AllocateMem(1, sizeof(ACHintResult), "hint result");
+}
+
+ACLIB_API void
+ACHintResultFree(ACHintResult* result)
+{
+    if (result == NULL)
+        return;
+
+    UnallocateMem(result->hints);
+    UnallocateMem(result->hintSets);
+    UnallocateMem(result->path);
+    UnallocateMem(result);
+}
+
+ACLIB_API void
+ACContextSetHintResult(ACContext* ctx, ACHintResult* result)
+{
+    if (ctx != NULL)
+        ctx->hintResult = result;
+}
+
+ACLIB_API void
+ACContextSetStats(ACContext* ctx, ACStats* stats)
+{
+    if (ctx != NULL)
+        ctx->stats = stats;
+}
+
+ACLIB_API void
+ACContextSetAnalyticBBox(ACContext* ctx, int analytic)
+{
+    if (ctx != NULL)
+        ctx->bbox.analytic = analytic != 0;
+}
+
 ACLIB_API int
 AutoHintString(const char* srcbezdata, const char* fontinfodata,
                ACBuffer* outbuffer, int allowEdit, int allowHintSub,
                int roundCoords)
 {
-    int value, result;
-    ACFontInfo* fontinfo = NULL;
+    if (defaultContext == NULL)
+        defaultContext = ACContextNew();
+    if (defaultContext == NULL)
+        return AC_FatalError;
+    defaultContext->callbacks = gDefaultCallbacks;
+
+    return AutoHintStringCtx(defaultContext, srcbezdata, fontinfodata,
+                             outbuffer, allowEdit, allowHintSub, roundCoords);
+}
+
+ACLIB_API int
+AutoHintStringCtx(ACContext* ctx, const char* srcbezdata,
+                  const char* fontinfodata, ACBuffer* outbuffer,
+                  int allowEdit, int allowHintSub, int roundCoords)
+{
+    int result;
+    ACFontInfo* fontinfo;
 
-    if (!srcbezdata)
+    if (!ctx || !srcbezdata)
         return AC_InvalidParameterError;
 
     fontinfo = ParseFontInfo(fontinfodata);
+    if (fontinfo == NULL)
+        return AC_FatalError;
+
+    result = AutoHintStringWithInfo(ctx, srcbezdata, fontinfo, outbuffer,
+                                    allowEdit, allowHintSub, roundCoords);
+    FreeFontInfo(fontinfo);
+
+    return result;
+}
+
+static int
+HintGlyph(ACContext* ctx, const GlyphSource* glyph, const ACFontInfo* fontinfo,
+          ACBuffer* outbuffer, int allowEdit, int allowHintSub,
+          int roundCoords)
+{
+    int value, result;
+    ACContext* saved = gContext;
+    jmp_buf mark; /* to handle exit() calls in the library version */
+
+    gContext = ctx;
+    ctx->errorMark = &mark;
 
     set_errorproc(error_handler);
-    value = setjmp(aclibmark);
+    value = setjmp(mark);
 
     /* We will return here whenever an error occurs during the execution of
      * AutoHint(), or after it finishes execution. See the error_handler
@@ -106,18 +294,23 @@ AutoHintString(const char* srcbezdata, const char* fontinfodata,
 
     if (value == -1) {
         /* a fatal error occurred somewhere. */
-        FreeFontInfo(fontinfo);
-        return AC_FatalError;
+        return end_call(saved, AC_FatalError);
     } else if (value == 1) {
         /* AutoHint was called successfully */
-        FreeFontInfo(fontinfo);
-
-        return AC_Success;
+        return end_call(saved, AC_Success);
     }
 
     gBezOutput = outbuffer;
+    if (gStats)
+        memset(gStats, 0, sizeof(ACStats));
+    if (gHintResult) {
+        gHintResult->glyphName[0] = '\0';
+        gHintResult->hintCount = 0;
+        gHintResult->hintSetCount = 0;
+        gHintResult->pathLength = 0;
+    }
     result = AutoHint(fontinfo,     /* font info */
-                      srcbezdata,   /* input glyph */
+                      glyph,        /* input glyph */
                       allowHintSub, /* extrahint */
                       allowEdit,    /* changeGlyphs */
                       roundCoords);
@@ -132,9 +325,59 @@ AutoHintString(const char* srcbezdata, const char* fontinfodata,
     return AC_UnknownError;
 }
 
+ACLIB_API int
+AutoHintStringWithInfo(ACContext* ctx, const char* srcbezdata,
+                       const ACFontInfo* fontinfo, ACBuffer* outbuffer,
+                       int allowEdit, int allowHintSub, int roundCoords)
+{
+    GlyphSource glyph;
+
+    if (!ctx || !srcbezdata || !fontinfo)
+        return AC_InvalidParameterError;
+
+    memset(&glyph, 0, sizeof(glyph));
+    glyph.bez = srcbezdata;
+
+    return HintGlyph(ctx, &glyph, fontinfo, outbuffer, allowEdit, allowHintSub,
+                     roundCoords);
+}
+
+ACLIB_API int
+AutoHintPath(ACContext* ctx, const char* glyphname, const ACPathElement* path,
+             size_t length, const ACFontInfo* fontinfo, ACBuffer* outbuffer,
+             int allowEdit, int allowHintSub, int roundCoords)
+{
+    GlyphSource glyph;
+
+    if (!ctx || !glyphname || (!path && length > 0) || !fontinfo)
+        return AC_InvalidParameterError;
+
+    memset(&glyph, 0, sizeof(glyph));
+    glyph.name = glyphname;
+    glyph.path = path;
+    glyph.pathLength = length;
+
+    return HintGlyph(ctx, &glyph, fontinfo, outbuffer, allowEdit, allowHintSub,
+                     roundCoords);
+}
+
 ACLIB_API int
 AutoHintStringMM(const char** srcbezdata, int nmasters, const char** masters,
                  ACBuffer** outbuffers)
+{
+    if (defaultContext == NULL)
+        defaultContext = ACContextNew();
+    if (defaultContext == NULL)
+        return AC_FatalError;
+    defaultContext->callbacks = gDefaultCallbacks;
+
+    return AutoHintStringMMCtx(defaultContext, srcbezdata, nmasters, masters,
+                               outbuffers);
+}
+
+ACLIB_API int
+AutoHintStringMMCtx(ACContext* ctx, const char** srcbezdata, int nmasters,
+                    const char** masters, ACBuffer** outbuffers)
 {
     /* Only the master with index 'hintsMasterIx' needs to be hinted.
      * This function expects that the master with index 'hintsMasterIx' has
@@ -160,12 +403,17 @@ AutoHintStringMM(const char** srcbezdata, int nmasters, const char** masters,
      * current master main or path elements. (This actually happens in
      * charpath.c::InsertHint().) */
     int value, result;
+    ACContext* saved = gContext;
+    jmp_buf mark; /* to handle exit() calls in the library version */
 
-    if (!srcbezdata)
+    if (!ctx || !srcbezdata)
         return AC_InvalidParameterError;
 
+    gContext = ctx;
+    ctx->errorMark = &mark;
+
     set_errorproc(error_handler);
-    value = setjmp(aclibmark);
+    value = setjmp(mark);
 
     /* We will return here whenever an error occurs during the execution of
      * AutoHint(), or after it finishes execution. See the error_handler
@@ -173,10 +421,10 @@ AutoHintStringMM(const char** srcbezdata, int nmasters, const char** masters,
 
     if (value == -1) {
         /* a fatal error occurred somewhere. */
-        return AC_FatalError;
+        return end_call(saved, AC_FatalError);
     } else if (value == 1) {
         /* AutoHint was called successfully */
-        return AC_Success;
+        return end_call(saved, AC_Success);
     }
 
     /* result == true is good */
@@ -191,20 +439,23 @@ AutoHintStringMM(const char** srcbezdata, int nmasters, const char** masters,
     return AC_UnknownError;
 }
 
+ACLIB_API ACFontInfo*
+ACFontInfoNew(const char* fontinfodata)
+{
+    return ParseFontInfo(fontinfodata);
+}
+
+ACLIB_API void
+ACFontInfoFree(ACFontInfo* fontinfo)
+{
+    FreeFontInfo(fontinfo);
+}
+
 ACLIB_API void
 AC_initCallGlobals(void)
 {
-    gLibReportCB = NULL;
-    gAddGlyphExtremesCB = NULL;
-    gAddStemExtremesCB = NULL;
-    gDoAligns = false;
-    gAddHStemCB = NULL;
-    gAddVStemCB = NULL;
-    gDoStems = false;
-    gAddStemUserData = NULL;
-    gAllStems = 0;
-    gReportRetryCB = NULL;
-    gReportRetryUserData = NULL;
+    memset(&gDefaultCallbacks, 0, sizeof(gDefaultCallbacks));
+    gDefaultCallbacks.logLevel = AC_LogDebug;
 }
 
 ACLIB_API const char*
@@ -13,15 +13,20 @@
 #include "charpath.h"
 #include "opcodes.h"
 
-char gGlyphName[MAX_GLYPHNAME_LEN];
-
-static Fixed currentx, currenty; /* used to calculate absolute coordinates */
-static Fixed tempx, tempy;       /* used to calculate relative coordinates */
-#define STKMAX (20)
-static Fixed stk[STKMAX];
-static int32_t stkindex;
-static bool flex, startchar;
-static bool forMultiMaster, includeHints;
+/* used to calculate absolute coordinates */
+#define currentx (gContext->read.currentx)
+#define currenty (gContext->read.currenty)
+/* used to calculate relative coordinates */
+#define tempx (gContext->read.tempx)
+#define tempy (gContext->read.tempy)
+#define stk (gContext->read.stk)
+#define stkindex (gContext->read.stkindex)
+#define flex (gContext->read.flex)
+#define startchar (gContext->read.startchar)
+#define forMultiMaster (gContext->read.forMultiMaster)
+#define includeHints (gContext->read.includeHints)
+/* reals with at most 2 decimals below this are converted exactly */
+#define MAXEXACTREAL 10000
 /* Reading file for comparison of multiple master data and hint information.
    Reads into GlyphPathElt structure instead of PathElt. */
 
@@ -251,140 +256,132 @@ ReadHintInfo(char nm, const char* str)
         SetHintsElt(hinttype, &c0, elt1, elt2, (bool)!startchar);
 }
 
-/*Used instead of StringEqual to keep ac from cloberring source string*/
+/* The bez operators, found through a perfect hash of their first and last
+ * characters and their length; OPHASH() has no collisions among them. */
+enum {
+    OpNone,
+    OpCT,
+    OpCP,
+    OpMT,
+    OpDT,
+    OpSC,
+    OpED,
+    OpHint, /* rm, rv, ry, rb */
+    OpRMT,
+    OpNop, /* snc, enc, endsubr, beginsubr, newcolors */
+    OpFLX,
+    OpPreFLX
+};
+
+typedef struct {
+    const char* name;
+    int op;
+} OpEntry;
+
+#define OPHASH(nm, len)                                                        \
+    (((unsigned char)(nm)[0] + 13 * (unsigned char)(nm)[(len)-1] +            \
+      6 * (unsigned)(len)) &                                                   \
+     31)
+
+static const OpEntry opTable[32] = {
+    [2] = { "beginsubr", OpNop },
+    [3] = { "ry", OpHint },
+    [4] = { "preflx2", OpPreFLX },
+    [5] = { "ed", OpED },
+    [6] = { "sc", OpSC },
+    [7] = { "rm", OpHint },
+    [8] = { "rmt", OpRMT },
+    [12] = { "snc", OpNop },
+    [16] = { "flx", OpFLX },
+    [19] = { "ct", OpCT },
+    [20] = { "dt", OpDT },
+    [23] = { "preflx1", OpPreFLX },
+    [24] = { "rb", OpHint },
+    [25] = { "endsubr", OpNop },
+    [27] = { "newcolors", OpNop },
+    [28] = { "rv", OpHint },
+    [29] = { "mt", OpMT },
+    [30] = { "enc", OpNop },
+    [31] = { "cp", OpCP },
+};
 
 static int
-isPrefix(const char* s, const char* pref)
+LookupOp(const char* nm, int len)
 {
-    while (*pref) {
-        if (*pref != *s)
-            return 0;
-        pref++;
-        s++;
-    }
-    return 1;
+    const OpEntry* entry = &opTable[OPHASH(nm, len)];
+
+    if (entry->name != NULL && strncmp(entry->name, nm, len) == 0 &&
+        entry->name[len] == '\0')
+        return entry->op;
+    /* Any other two letter name starting with 'r' has always been read as
+     * an rv hint. */
+    if (len == 2 && nm[0] == 'r')
+        return OpHint;
+    return OpNone;
 }
 
 static void
 DoName(const char* nm, const char* buff, int len)
 {
-    switch (len) {
-        case 2:
-            switch (nm[0]) {
-                case 'c': /* ct, cp */
-                    switch (nm[1]) {
-                        case 't':
-                            psCT();
-                            break;
-                        case 'p':
-                            psCP();
-                            break;
-                        default:
-                            goto badFile;
-                    }
-                    break;
-                case 'm': /* mt */
-                    if (nm[1] != 't')
-                        goto badFile;
-                    psMT();
-                    break;
-                case 'd': /* dt */
-                    if (nm[1] != 't')
-                        goto badFile;
-                    psDT();
-                    break;
-                case 's': /* sc */
-                    if (nm[1] != 'c')
-                        goto badFile;
-                    startchar = true;
-                    break;
-                case 'e': /* ed */
-                    if (nm[1] != 'd')
-                        goto badFile;
-                    break;
-                case 'r': /* rm, rv, ry, rb */
-                    if (includeHints)
-                        ReadHintInfo(nm[1], buff);
-                    else
-                        Pop2();
-                    break;
-                default:
-                    goto badFile;
-            }
+    switch (LookupOp(nm, len)) {
+        case OpCT:
+            psCT();
             break;
-        case 3:
-            switch (nm[0]) {
-                case 'r': /* rmt */
-                    if (nm[1] != 'm' || nm[2] != 't')
-                        goto badFile;
-                    psRMT();
-                    break;
-                case 's': /* snc */
-                case 'e': /* enc */
-                    switch (nm[1]) {
-                        case 'n':
-                            if (nm[2] != 'c')
-                                goto badFile;
-                            break;
-                        default:
-                            goto badFile;
-                    }
-                    break;
-                case 'f': /* flx */
-                    if (nm[1] == 'l' && nm[2] == 'x')
-                        psFLX();
-                    else
-                        goto badFile;
-                    break;
-                default:
-                    goto badFile;
-            }
+        case OpCP:
+            psCP();
             break;
-        case 7:
-            switch (nm[6]) {
-                case '1': /* preflx1 */
-                case '2': /* preflx2 */
-                    if (nm[0] != 'p' || nm[1] != 'r' || nm[2] != 'e' ||
-                        nm[3] != 'f' || nm[4] != 'l' || nm[5] != 'x')
-                        goto badFile;
-                    flex = true;
-                    break;
-                case 'r': /* endsubr */
-                    if (!isPrefix(nm, "endsubr"))
-                        goto badFile;
-                    break;
-                default:
-                    goto badFile;
-            }
+        case OpMT:
+            psMT();
             break;
-        case 9:
-            switch (nm[0]) {
-                case 'b': /* beginsubr */
-                    if (!isPrefix(nm, "beginsubr"))
-                        goto badFile;
-                    break;
-                case 'n': /* newhints */
-                    if (!isPrefix(nm, "newcolors"))
-                        goto badFile;
-                    break;
-                default:
-                    goto badFile;
-            }
+        case OpDT:
+            psDT();
+            break;
+        case OpSC:
+            startchar = true;
             break;
-        default:
-            goto badFile;
+        case OpHint:
+            if (includeHints)
+                ReadHintInfo(nm[1], buff);
+            else
+                Pop2();
+            break;
+        case OpRMT:
+            psRMT();
+            break;
+        case OpFLX:
+            psFLX();
+            break;
+        case OpPreFLX:
+            flex = true;
+            break;
+        case OpED:
+        case OpNop:
+            break;
+        default: {
+            char op[80];
+            if (len > 79)
+                len = 79;
+            strncpy(op, nm, len);
+            op[len] = 0;
+
+            LogMsg(LOGERROR, NONFATALERROR,
+                   "Bad file format. Unknown operator: %s.", op);
+        }
     }
-    return;
-badFile : {
-    char op[80];
-    if (len > 79)
-        len = 79;
-    strncpy(op, nm, len);
-    op[len] = 0;
-
-    LogMsg(LOGERROR, NONFATALERROR, "Bad file format. Unknown operator: %s.",
-           op);
 }
+
+static void
+SetGlyphName(const char* name, size_t len)
+{
+    if (len >= MAX_GLYPHNAME_LEN) {
+        LogMsg(LOGERROR, NONFATALERROR,
+               "Bad input data. Glyph name is greater than %d chars.",
+               MAX_GLYPHNAME_LEN);
+        len = MAX_GLYPHNAME_LEN - 1;
+    }
+
+    strncpy(gGlyphName, name, len);
+    gGlyphName[len] = '\0';
 }
 
 static void
@@ -394,9 +391,10 @@ ParseString(const char* s)
     char c;
     const char* c0;
     bool neg = false;
-    bool isReal;
-    float rval;
-    int32_t val = 0;
+    bool isReal, exact;
+    float rval, hundredths;
+    int32_t val = 0, frac;
+    int fracDigits;
     Fixed r;
     gPathStart = gPathEnd = NULL;
     gGlyphName[0] = '\0';
@@ -419,16 +417,7 @@ ParseString(const char* s)
                            (s[end] != '\n'))
                         end++;
 
-                    if (end >= MAX_GLYPHNAME_LEN) {
-                        LogMsg(LOGERROR, NONFATALERROR,
-                               "Bad input data. Glyph name is greater than "
-                               "%d chars.",
-                               MAX_GLYPHNAME_LEN);
-                        end = MAX_GLYPHNAME_LEN - 1;
-                    }
-
-                    strncpy(gGlyphName, s, end);
-                    gGlyphName[end] = '\0';
+                    SetGlyphName(s, end);
                 }
                 while (*s && (*s != '\n') && (*s != '\r')) {
                     s++;
@@ -474,20 +463,42 @@ ParseString(const char* s)
         }
     rdnum:
         isReal = false;
+        exact = true;
+        frac = 0;
+        fracDigits = 0;
         c0 = s - 1;
         while (true) {
             c = *s++;
-            if (c == '.')
+            if (c == '.') {
+                exact = exact && !isReal;
                 isReal = true;
-            else if (c >= '0' && c <= '9')
-                val = val * 10 + (c - '0');
-            else if ((c == ' ') || (c == '\t')) {
+            } else if (c >= '0' && c <= '9') {
+                if (!isReal)
+                    val = val * 10 + (c - '0');
+                else if (fracDigits < 2) {
+                    frac = frac * 10 + (c - '0');
+                    fracDigits++;
+                } else
+                    exact = false;
+            } else if ((c == ' ') || (c == '\t')) {
                 if (isReal) {
-                    rval = strtod(c0, NULL);
-                    /* Autohint only supports 2 digits of decimal precision. */
-                    rval = roundf(rval * 100) / 100;
-                    /* do not need to use 'neg' to negate the value, as c0
-                     * string includes the minus sign.*/
+                    /* Autohint only supports 2 digits of decimal precision.
+                     * Up to that precision and below MAXEXACTREAL the
+                     * number of hundredths is the one strtod() and roundf()
+                     * would give, so only other numbers go through them. */
+                    if (exact && val < MAXEXACTREAL) {
+                        hundredths =
+                          (float)(val * 100 + (fracDigits == 1 ? frac * 10
+                                                                : frac));
+                        if (neg)
+                            hundredths = -hundredths;
+                    } else {
+                        /* do not need to use 'neg' to negate the value, as
+                         * c0 string includes the minus sign.*/
+                        rval = strtod(c0, NULL);
+                        hundredths = roundf(rval * 100);
+                    }
+                    rval = hundredths / 100;
                     r = FixReal(rval); /* convert to Fixed */
                 } else {
                     if (neg)
@@ -520,3 +531,54 @@ ReadGlyph(const char* srcglyph, bool forBlendData, bool readHints)
 
     return true;
 }
+
+/* Builds the path from path elements instead of parsing bez data. */
+bool
+ReadGlyphPath(const char* name, const ACPathElement* path, size_t length)
+{
+    size_t i;
+
+    if (!name || (!path && length > 0))
+        return false;
+
+    currentx = currenty = tempx = tempy = stkindex = 0;
+    flex = startchar = false;
+    forMultiMaster = false;
+    includeHints = false;
+
+    gPathStart = gPathEnd = NULL;
+    SetGlyphName(name, strlen(name));
+
+    for (i = 0; i < length; i++) {
+        const int32_t* v = path[i].coords;
+        Cd c1, c2, c3;
+
+        switch (path[i].op) {
+            case AC_MoveTo:
+            case AC_LineTo:
+                currentx = v[0];
+                currenty = v[1];
+                RDmtlt(path[i].op == AC_MoveTo ? MOVETO : LINETO);
+                break;
+            case AC_CurveTo:
+                c1.x = v[0];
+                c1.y = v[1];
+                c2.x = v[2];
+                c2.y = v[3];
+                c3.x = currentx = v[4];
+                c3.y = currenty = v[5];
+                RDcurveto(c1, c2, c3);
+                break;
+            case AC_ClosePath:
+                AppendElement(CLOSEPATH);
+                break;
+            default:
+                LogMsg(LOGERROR, NONFATALERROR,
+                       "Bad input data. Unknown path operator: %d.",
+                       path[i].op);
+                return false;
+        }
+    }
+
+    return true;
+}
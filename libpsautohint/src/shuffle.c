@@ -8,14 +8,12 @@
  */
 
 #include "ac.h"
-#define MAXCNT (100)
 
-static int32_t rowcnt;
-
-unsigned char*
+SubpathLinks*
 InitShuffleSubpaths(void)
 {
     int32_t cnt = -1;
+    SubpathLinks* links;
     PathElt* e = gPathStart;
     while (e != NULL) { /* every element is marked with its subpath count */
         if (e->type == MOVETO)
@@ -28,16 +26,28 @@ InitShuffleSubpaths(void)
         e = e->next;
     }
     cnt++;
-    rowcnt = cnt;
-    if (cnt < 4 || cnt >= MAXCNT)
+    if (cnt < 4)
         return NULL;
-    return Alloc(cnt * cnt);
+    links = (SubpathLinks*)Alloc(sizeof(SubpathLinks));
+    links->cnt = cnt;
+    links->starts = (PathElt**)Alloc(cnt * sizeof(PathElt*));
+    for (e = gPathStart; e != NULL; e = e->next) {
+        if (e->type == MOVETO)
+            links->starts[e->count] = e;
+    }
+    return links;
 }
 
+/* The links as a graph: the subpaths linked to subpath i, in increasing
+ * order, are adj[first[i]] to adj[first[i + 1] - 1]. */
+typedef struct {
+    int32_t *first, *adj;
+} LinkGraph;
+
 static void
-PrintLinks(unsigned char* links)
+PrintLinks(SubpathLinks* links, LinkGraph* g)
 {
-    int32_t i, j;
+    int32_t i, j, rowcnt = links->cnt;
     LogMsg(LOGDEBUG, OK, "Links ");
     for (i = 0; i < rowcnt; i++) {
         LogMsg(LOGDEBUG, OK, "%d  ", i);
@@ -46,18 +56,22 @@ PrintLinks(unsigned char* links)
     }
     LogMsg(LOGDEBUG, OK, "\n");
     for (i = 0; i < rowcnt; i++) {
+        int32_t k = g->first[i];
         LogMsg(LOGDEBUG, OK, " %d   ", i);
         if (i < 10)
             LogMsg(LOGDEBUG, OK, " ");
         for (j = 0; j < rowcnt; j++) {
-            LogMsg(LOGDEBUG, OK, "%d   ", links[rowcnt * i + j]);
+            int32_t lnk = k < g->first[i + 1] && g->adj[k] == j;
+            if (lnk)
+                k++;
+            LogMsg(LOGDEBUG, OK, "%d   ", lnk);
         }
         LogMsg(LOGDEBUG, OK, "\n");
     }
 }
 
 static void
-PrintSumLinks(char* sumlinks)
+PrintSumLinks(int32_t* sumlinks, int32_t rowcnt)
 {
     int32_t i;
     LogMsg(LOGDEBUG, OK, "Sumlinks ");
@@ -75,7 +89,7 @@ PrintSumLinks(char* sumlinks)
 }
 
 static void
-PrintOutLinks(unsigned char* outlinks)
+PrintOutLinks(int32_t* outlinks, int32_t rowcnt)
 {
     int32_t i;
     LogMsg(LOGDEBUG, OK, "Outlinks ");
@@ -92,8 +106,25 @@ PrintOutLinks(unsigned char* outlinks)
     LogMsg(LOGDEBUG, OK, "\n");
 }
 
+static void
+AddLink(SubpathLinks* links, int32_t i, int32_t j)
+{
+    if (links->numPairs == links->maxPairs) {
+        int32_t* pairs;
+        links->maxPairs = links->maxPairs > 0 ? 2 * links->maxPairs : 64;
+        pairs = (int32_t*)Alloc(2 * links->maxPairs * sizeof(int32_t));
+        if (links->numPairs > 0)
+            memcpy(pairs, links->pairs,
+                   2 * links->numPairs * sizeof(int32_t));
+        links->pairs = pairs;
+    }
+    links->pairs[2 * links->numPairs] = NUMMIN(i, j);
+    links->pairs[2 * links->numPairs + 1] = NUMMAX(i, j);
+    links->numPairs++;
+}
+
 void
-MarkLinks(HintVal* vL, bool hFlg, unsigned char* links)
+MarkLinks(HintVal* vL, bool hFlg, SubpathLinks* links)
 {
     int32_t i, j;
     HintSeg* seg;
@@ -117,98 +148,176 @@ MarkLinks(HintVal* vL, bool hFlg, unsigned char* links)
         j = e->count;
         if (i == j)
             continue;
-        if (hFlg)
-            ShowHVal(vL);
-        else
-            ShowVVal(vL);
-        LogMsg(LOGDEBUG, OK, " : %d <-> %d", i, j);
-        links[rowcnt * i + j] = 1;
-        links[rowcnt * j + i] = 1;
+        if (LogEnabled(LOGDEBUG)) {
+            if (hFlg)
+                ShowHVal(vL);
+            else
+                ShowVVal(vL);
+            LogMsg(LOGDEBUG, OK, " : %d <-> %d", i, j);
+        }
+        AddLink(links, i, j);
     }
 }
 
+static int
+ComparePairs(const void* a, const void* b)
+{
+    const int32_t* pa = (const int32_t*)a;
+    const int32_t* pb = (const int32_t*)b;
+    if (pa[0] != pb[0])
+        return pa[0] < pb[0] ? -1 : 1;
+    if (pa[1] != pb[1])
+        return pa[1] < pb[1] ? -1 : 1;
+    return 0;
+}
+
+/* Builds the graph from the marked pairs, dropping repeats. Since the pairs
+ * are sorted, each row gets its subpaths in increasing order. */
 static void
-Outpath(unsigned char* links, unsigned char* outlinks, unsigned char* output,
-        int32_t bst)
+BuildLinkGraph(SubpathLinks* links, LinkGraph* g)
 {
-    unsigned char *lnks, *outlnks;
-    int32_t i = bst;
-    PathElt* e = gPathStart;
-    while (e != NULL) {
-        if (e->count == i)
-            break;
-        e = e->next;
+    int32_t i, k, n = 0, cnt = links->cnt;
+    int32_t* p = links->pairs;
+    int32_t* fill;
+    if (links->numPairs > 1)
+        qsort(p, links->numPairs, 2 * sizeof(int32_t), ComparePairs);
+    for (i = 0; i < links->numPairs; i++) {
+        if (n == 0 || ComparePairs(&p[2 * i], &p[2 * (n - 1)]) != 0) {
+            p[2 * n] = p[2 * i];
+            p[2 * n + 1] = p[2 * i + 1];
+            n++;
+        }
     }
-    if (e == NULL)
-        return;
-    MoveSubpathToEnd(e);
+    g->first = (int32_t*)Alloc((cnt + 1) * sizeof(int32_t));
+    g->adj = (int32_t*)Alloc((2 * n + 1) * sizeof(int32_t));
+    fill = (int32_t*)Alloc(cnt * sizeof(int32_t));
+    for (i = 0; i < n; i++) {
+        g->first[p[2 * i] + 1]++;
+        g->first[p[2 * i + 1] + 1]++;
+    }
+    for (i = 0; i < cnt; i++) {
+        g->first[i + 1] += g->first[i];
+        fill[i] = g->first[i];
+    }
+    for (k = 0; k < n; k++) {
+        g->adj[fill[p[2 * k]]++] = p[2 * k + 1];
+        g->adj[fill[p[2 * k + 1]]++] = p[2 * k];
+    }
+}
+
+/* The subpaths not yet output, as a binary heap with the next one to output
+ * at the top: the one with the most links to the output ones, then the one
+ * with the most links, then the first one. pos[i] is the place of subpath i
+ * in the heap, or -1 once it is output. */
+typedef struct {
+    int32_t *heap, *pos, *outlinks, *sumlinks;
+    int32_t size;
+} ShuffleQueue;
+
+static bool
+ShuffleBefore(ShuffleQueue* q, int32_t a, int32_t b)
+{
+    if (q->outlinks[a] != q->outlinks[b])
+        return q->outlinks[a] > q->outlinks[b];
+    if (q->sumlinks[a] != q->sumlinks[b])
+        return q->sumlinks[a] > q->sumlinks[b];
+    return a < b;
+}
+
+static void
+ShuffleSwap(ShuffleQueue* q, int32_t h1, int32_t h2)
+{
+    int32_t s = q->heap[h1];
+    q->heap[h1] = q->heap[h2];
+    q->heap[h2] = s;
+    q->pos[q->heap[h1]] = h1;
+    q->pos[q->heap[h2]] = h2;
+}
+
+static void
+ShuffleUp(ShuffleQueue* q, int32_t h)
+{
+    while (h > 0 && ShuffleBefore(q, q->heap[h], q->heap[(h - 1) / 2])) {
+        ShuffleSwap(q, h, (h - 1) / 2);
+        h = (h - 1) / 2;
+    }
+}
+
+static void
+ShuffleDown(ShuffleQueue* q, int32_t h)
+{
+    while (true) {
+        int32_t c = 2 * h + 1;
+        if (c >= q->size)
+            return;
+        if (c + 1 < q->size && ShuffleBefore(q, q->heap[c + 1], q->heap[c]))
+            c++;
+        if (!ShuffleBefore(q, q->heap[c], q->heap[h]))
+            return;
+        ShuffleSwap(q, h, c);
+        h = c;
+    }
+}
+
+static int32_t
+ShufflePop(ShuffleQueue* q)
+{
+    int32_t bst = q->heap[0];
+    q->size--;
+    if (q->size > 0) {
+        ShuffleSwap(q, 0, q->size);
+        ShuffleDown(q, 0);
+    }
+    q->pos[bst] = -1;
+    return bst;
+}
+
+static void
+Outpath(SubpathLinks* links, LinkGraph* g, ShuffleQueue* q, int32_t bst)
+{
+    int32_t k;
+    MoveSubpathToEnd(links->starts[bst]);
     LogMsg(LOGDEBUG, OK, "move subpath %d to end.", bst);
-    output[bst] = 1;
-    lnks = &links[bst * rowcnt];
-    outlnks = outlinks;
-    for (i = 0; i < rowcnt; i++)
-        *outlnks++ += *lnks++;
-    PrintOutLinks(outlinks);
+    for (k = g->first[bst]; k < g->first[bst + 1]; k++) {
+        int32_t i = g->adj[k];
+        q->outlinks[i]++;
+        if (q->pos[i] >= 0)
+            ShuffleUp(q, q->pos[i]);
+    }
+    DebugReport(PrintOutLinks(q->outlinks, links->cnt));
 }
 
 /* The intent of this code is to order the subpaths so that
  the hints will not need to change constantly because it
  is jumping from one subpath to another.  Kanji glyphs
  had the most problems with this which caused huge files
- to be created. */
+ to be created.
+ The next subpath is the one most linked to those already moved to the
+ end; if none is linked to them, the one with the most links starts a new
+ run. */
 void
-DoShuffleSubpaths(unsigned char* links)
+DoShuffleSubpaths(SubpathLinks* links)
 {
-    unsigned char sumlinks[MAXCNT], output[MAXCNT], outlinks[MAXCNT];
-    unsigned char* lnks;
-    int32_t i, j;
-    memset(sumlinks, 0, MAXCNT * sizeof(unsigned char));
-    memset(output, 0, MAXCNT * sizeof(unsigned char));
-    memset(outlinks, 0, MAXCNT * sizeof(unsigned char));
+    LinkGraph g;
+    ShuffleQueue q;
+    int32_t i, cnt;
     if (links == NULL)
         return;
-    PrintLinks(links);
-    for (i = 0; i < rowcnt; i++)
-        output[i] = sumlinks[i] = outlinks[i] = 0;
-    lnks = links;
-    for (i = 0; i < rowcnt; i++) {
-        for (j = 0; j < rowcnt; j++) {
-            if (*lnks++ != 0)
-                sumlinks[i]++;
-        }
-    }
-    PrintSumLinks((char*)sumlinks);
-    while (true) {
-        int32_t bst = -1;
-        int32_t bstsum = 0;
-        for (i = 0; i < rowcnt; i++) {
-            if (output[i] == 0 && (bst == -1 || sumlinks[i] > bstsum)) {
-                bstsum = sumlinks[i];
-                bst = i;
-            }
-        }
-        if (bst == -1)
-            break;
-        Outpath(links, outlinks, output, bst);
-        while (true) {
-            int32_t bstlnks;
-            bst = -1;
-            bstsum = 0;
-            bstlnks = 0;
-            for (i = 0; i < rowcnt; i++) {
-                if (output[i] == 0 && outlinks[i] >= bstlnks) {
-                    if (outlinks[i] > 0 &&
-                        (bst == -1 || outlinks[i] > bstlnks ||
-                         (outlinks[i] == bstlnks && sumlinks[i] > bstsum))) {
-                        bstlnks = outlinks[i];
-                        bst = i;
-                        bstsum = sumlinks[i];
-                    }
-                }
-            }
-            if (bst == -1)
-                break;
-            Outpath(links, outlinks, output, bst);
-        }
+    cnt = links->cnt;
+    BuildLinkGraph(links, &g);
+    DebugReport(PrintLinks(links, &g));
+    q.heap = (int32_t*)Alloc(cnt * sizeof(int32_t));
+    q.pos = (int32_t*)Alloc(cnt * sizeof(int32_t));
+    q.outlinks = (int32_t*)Alloc(cnt * sizeof(int32_t));
+    q.sumlinks = (int32_t*)Alloc(cnt * sizeof(int32_t));
+    for (i = 0; i < cnt; i++) {
+        q.sumlinks[i] = g.first[i + 1] - g.first[i];
+        q.heap[i] = q.pos[i] = i;
     }
+    q.size = cnt;
+    DebugReport(PrintSumLinks(q.sumlinks, cnt));
+    for (i = cnt / 2 - 1; i >= 0; i--)
+        ShuffleDown(&q, i);
+    while (q.size > 0)
+        Outpath(links, &g, &q, ShufflePop(&q));
 }
@@ -13,14 +13,11 @@
 
 #define WRTABS_COMMENT (0)
 
-static Fixed currentx, currenty;
-static bool firstFlex, wrtHintInfo;
-#define MAXBUFFLEN 127
-static char S0[MAXBUFFLEN + 1];
-static HintPoint* bst;
-static char bch;
-static Fixed bx, by;
-static bool bstB;
+#define currentx (gContext->write.currentx)
+#define currenty (gContext->write.currenty)
+#define firstFlex (gContext->write.firstFlex)
+#define wrtHintInfo (gContext->write.wrtHintInfo)
+#define S0 (gContext->write.S0)
 
 int32_t
 FRnd(int32_t x)
@@ -36,11 +33,87 @@ FRnd(int32_t x)
     return r;
 }
 
+/* Numbers are formatted by hand rather than with vsnprintf(), which is slow
+ * and the output only needs two formats: "%d " for integers and "%0.2f " for
+ * 24.8 fixed point values rounded to two decimals. The output is the same as
+ * with the printf formats. */
+
+#define NUMBUFFLEN 24
+
+static size_t
+FormatInt(char* s, int32_t value)
+{
+    char digits[12];
+    size_t n = 0, len = 0;
+    uint32_t u = value < 0 ? 0U - (uint32_t)value : (uint32_t)value;
+
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+
+    if (value < 0)
+        s[len++] = '-';
+    while (n > 0)
+        s[len++] = digits[--n];
+    s[len++] = ' ';
+
+    return len;
+}
+
+/* Formats the value the same way as printing the float FIXED2FLOAT(value)
+ * rounded to two decimals with "%0.2f " does. */
+static size_t
+FormatFixed(char* s, Fixed value)
+{
+    uint32_t hundredths, u;
+    size_t len = 0;
+
+    /* Larger values are not exact as floats, leave them to printf. */
+    if (value >= (1 << 24) || value <= -(1 << 24))
+        return (size_t)snprintf(
+          s, NUMBUFFLEN, "%0.2f ",
+          round((double)FIXED2FLOAT(value) * 100) / 100);
+
+    /* value * 100 / 256 rounded half away from zero, like round() */
+    u = value < 0 ? 0U - (uint32_t)value : (uint32_t)value;
+    hundredths = (u * 25 + 32) >> 6;
+
+    /* a negative value rounded to zero gives -0.00, as with printf */
+    if (value < 0)
+        s[len++] = '-';
+    len += FormatInt(s + len, (int32_t)(hundredths / 100)) - 1;
+    u = hundredths % 100;
+    s[len++] = '.';
+    s[len++] = (char)('0' + u / 10);
+    s[len++] = (char)('0' + u % 10);
+    s[len++] = ' ';
+
+    return len;
+}
+
+/* Writes value followed by a space. */
+void
+BufferWriteInt(ACBuffer* buffer, int32_t value)
+{
+    char s[NUMBUFFLEN];
+    ACBufferWrite(buffer, s, FormatInt(s, value));
+}
+
+/* Writes value with two decimals, followed by a space. */
+void
+BufferWriteFixed(ACBuffer* buffer, Fixed value)
+{
+    char s[NUMBUFFLEN];
+    ACBufferWrite(buffer, s, FormatFixed(s, value));
+}
+
 #define WriteString(...) ACBufferWriteF(gBezOutput, __VA_ARGS__)
+#define WriteLiteral(str) ACBufferWrite(gBezOutput, str, sizeof(str) - 1)
 
 /* Note: The 8 bit fixed fraction cannot support more than 2 decimal places. */
-#define WRTNUM(i) WriteString("%d ", (int32_t)(i))
-#define WRTRNUM(i) WriteString("%0.2f ", round((double)(i)*100) / 100)
+#define WRTNUM(i) BufferWriteInt(gBezOutput, (int32_t)(i))
+#define WRTRNUM(i) BufferWriteFixed(gBezOutput, i)
 
 static void
 wrtxa(Fixed x)
@@ -50,10 +123,8 @@ wrtxa(Fixed x)
         WRTNUM(FTrunc(i));
         currentx = i;
     } else {
-        float r;
         currentx = x;
-        r = (float)FIXED2FLOAT(x);
-        WRTRNUM(r);
+        WRTRNUM(x);
     }
 }
 
@@ -65,10 +136,8 @@ wrtya(Fixed y)
         WRTNUM(FTrunc(i));
         currenty = i;
     } else {
-        float r;
         currenty = y;
-        r = (float)FIXED2FLOAT(y);
-        WRTRNUM(r);
+        WRTRNUM(y);
     }
 }
 
@@ -77,62 +146,39 @@ wrtya(Fixed y)
     wrtya(c.y)
 
 /*To avoid pointless hint subs*/
-#define HINTMAXSTR 2048
-static char hintmaskstr[HINTMAXSTR];
-static char prevhintmaskstr[HINTMAXSTR];
+#define hintmaskstr (gContext->write.hintmaskstr)
+#define prevhintmaskstr (gContext->write.prevhintmaskstr)
+#define hintmasklen (gContext->write.hintmasklen)
+#define prevhintmasklen (gContext->write.prevhintmasklen)
+#define prevPtLst (gContext->write.prevPtLst)
+#define sortedLsts (gContext->write.sortedLsts)
+#define sortedCnts (gContext->write.sortedCnts)
 
 static void
-safestrcat(char* s1, char* s2)
+AppendHintMask(const char* s, size_t len)
 {
-    if (strlen(s1) + strlen(s2) + 1 > HINTMAXSTR) {
+    if (hintmasklen + len + 1 > HINTMAXSTR) {
         LogMsg(LOGERROR, FATALERROR, "Hint information overflowing buffer.");
     } else {
-        strcat(s1, s2);
+        memcpy(hintmaskstr + hintmasklen, s, len);
+        hintmasklen += len;
+        hintmaskstr[hintmasklen] = '\0';
     }
 }
 
-#define sws(str) safestrcat(hintmaskstr, (char*)str)
+#define sws(str) AppendHintMask(str, strlen(str))
 
-#define SWRTNUM(i)                                                             \
-    {                                                                          \
-        snprintf(S0, MAXBUFFLEN, "%d ", (int32_t)(i));                         \
-        sws(S0);                                                               \
-    }
-
-#define SWRTNUMA(i)                                                            \
-    {                                                                          \
-        snprintf(S0, MAXBUFFLEN, "%0.2f ", round((double)(i)*100) / 100);      \
-        sws(S0);                                                               \
-    }
+#define SWRTNUM(i) AppendHintMask(S0, FormatInt(S0, (int32_t)(i)))
 
-static void
-NewBest(HintPoint* lst)
-{
-    bst = lst;
-    bch = lst->c;
-    if (bch == 'y' || bch == 'm') {
-        Fixed x0, x1;
-        bstB = true;
-        x0 = lst->x0;
-        x1 = lst->x1;
-        bx = NUMMIN(x0, x1);
-    } else {
-        Fixed y0, y1;
-        bstB = false;
-        y0 = lst->y0;
-        y1 = lst->y1;
-        by = NUMMIN(y0, y1);
-    }
-}
+#define SWRTNUMA(i) AppendHintMask(S0, FormatFixed(S0, i))
 
 static void
 WriteOne(Fixed s)
 { /* write s to output file */
     if (FracPart(s) == 0) {
-        SWRTNUM(FTrunc(s))
+        SWRTNUM(FTrunc(s));
     } else {
-        float d = (float)FIXED2FLOAT(s);
-        SWRTNUMA(d);
+        SWRTNUMA(s);
     }
 }
 
@@ -162,57 +208,234 @@ WritePointItem(HintPoint* lst)
     sws("\n");
 }
 
+/* The hints are written by kind ('y' 'v' 'm' 'b', the reverse of their
+ * character order) and then from the lowest edge up; equal ones keep their
+ * order in the list. */
+typedef struct {
+    HintPoint* pt;
+    Fixed loc;
+    int32_t idx;
+} PntKey;
+
+static int
+ComparePntKeys(const void* a, const void* b)
+{
+    const PntKey* ka = (const PntKey*)a;
+    const PntKey* kb = (const PntKey*)b;
+    if (ka->pt->c != kb->pt->c)
+        return ka->pt->c > kb->pt->c ? -1 : 1;
+    if (ka->loc != kb->loc)
+        return ka->loc < kb->loc ? -1 : 1;
+    return ka->idx < kb->idx ? -1 : (ka->idx > kb->idx ? 1 : 0);
+}
+
+/* Returns the hints of gPtLstArray[ix] in the order they are written in,
+ * and their number in *pcnt. Each list is only sorted the first time. */
+static HintPoint**
+SortedPntLst(int32_t ix, int32_t* pcnt)
+{
+    HintPoint* lst;
+    HintPoint** pts;
+    PntKey* keys;
+    int32_t i, cnt = 0;
+    if (sortedLsts[ix] != NULL) {
+        *pcnt = sortedCnts[ix];
+        return sortedLsts[ix];
+    }
+    for (lst = gPtLstArray[ix]; lst != NULL; lst = lst->next)
+        cnt++;
+    keys = (PntKey*)Alloc((cnt + 1) * sizeof(PntKey));
+    pts = (HintPoint**)Alloc((cnt + 1) * sizeof(HintPoint*));
+    for (lst = gPtLstArray[ix], i = 0; lst != NULL; lst = lst->next, i++) {
+        keys[i].pt = lst;
+        if (lst->c == 'y' || lst->c == 'm')
+            keys[i].loc = NUMMIN(lst->x0, lst->x1);
+        else
+            keys[i].loc = NUMMIN(lst->y0, lst->y1);
+        keys[i].idx = i;
+    }
+    if (cnt > 1)
+        qsort(keys, cnt, sizeof(PntKey), ComparePntKeys);
+    for (i = 0; i < cnt; i++)
+        pts[i] = keys[i].pt;
+    sortedLsts[ix] = pts;
+    sortedCnts[ix] = cnt;
+    *pcnt = cnt;
+    return pts;
+}
+
+/* Builds hintmaskstr for gPtLstArray[ix]. */
 static void
-WrtPntLst(HintPoint* lst)
+WrtPntLst(int32_t ix)
+{
+    HintPoint** pts;
+    int32_t i, cnt;
+    pts = SortedPntLst(ix, &cnt);
+    hintmaskstr[0] = '\0';
+    hintmasklen = 0;
+    for (i = 0; i < cnt; i++)
+        WritePointItem(pts[i]);
+}
+
+static bool
+SameWrittenHint(HintPoint* p, HintPoint* q)
 {
-    HintPoint* ptLst;
-    char ch;
-    Fixed x0, x1, y0, y1;
-    ptLst = lst;
-
-    while (lst != NULL) { /* mark all as not yet done */
-        lst->done = false;
-        lst = lst->next;
+    if (p->c != q->c)
+        return false;
+    if (p->c == 'y' || p->c == 'm') {
+        if (p->x0 != q->x0 || p->x1 - p->x0 != q->x1 - q->x0)
+            return false;
+    } else if (p->y0 != q->y0 || p->y1 - p->y0 != q->y1 - q->y0) {
+        return false;
     }
-    while (true) { /* write in sort order */
-        lst = ptLst;
-        bst = NULL;
-        while (lst != NULL) { /* find first not yet done as init best */
-            if (!lst->done) {
-                NewBest(lst);
-                break;
-            }
-            lst = lst->next;
-        }
-        if (bst == NULL) {
-            break; /* finished with entire list */
-        }
-        lst = bst->next;
-        while (lst != NULL) { /* search for best */
-            if (!lst->done) {
-                ch = lst->c;
-                if (ch > bch) {
-                    NewBest(lst);
-                } else if (ch == bch) {
-                    if (bstB) {
-                        x0 = lst->x0;
-                        x1 = lst->x1;
-                        if (NUMMIN(x0, x1) < bx) {
-                            NewBest(lst);
-                        }
-                    } else {
-                        y0 = lst->y0;
-                        y1 = lst->y1;
-                        if (NUMMIN(y0, y1) < by) {
-                            NewBest(lst);
-                        }
-                    }
-                }
-            }
-            lst = lst->next;
+    return (p->p0 != NULL ? p->p0->count : 0) ==
+             (q->p0 != NULL ? q->p0->count : 0) &&
+           (p->p1 != NULL ? p->p1->count : 0) ==
+             (q->p1 != NULL ? q->p1->count : 0);
+}
+
+/* true if gPtLstArray[ix1] and gPtLstArray[ix2] are written the same, from
+ * the numbers the text is made of. Different numbers can still round to
+ * the same text, so false only means that the texts need comparing. */
+static bool
+SamePntLsts(int32_t ix1, int32_t ix2)
+{
+    HintPoint **pts1, **pts2;
+    int32_t i, cnt1, cnt2;
+    if (ix1 == ix2)
+        return true;
+    pts1 = SortedPntLst(ix1, &cnt1);
+    pts2 = SortedPntLst(ix2, &cnt2);
+    if (cnt1 != cnt2)
+        return false;
+    for (i = 0; i < cnt1; i++) {
+        if (!SameWrittenHint(pts1[i], pts2[i]))
+            return false;
+    }
+    return true;
+}
+
+/* Structured output, see ACContextSetHintResult(). */
+
+static void*
+GrowResultArray(void* array, size_t* capacity, size_t elsize)
+{
+    size_t size = *capacity ? *capacity * 2 : 16;
+
+    array = ReallocateMem(array, size * elsize, "hint result");
+    *capacity = size;
+    return array;
+}
+
+static int32_t
+ElementIndex(PathElt* e)
+{
+    return e != NULL ? e->count - 1 : -1;
+}
+
+static void
+ResultHint(HintPoint* lst)
+{
+    ACHintResult* result = gHintResult;
+    ACStemHint* hint;
+
+    if (result->hintCount == result->hintCapacity)
+        result->hints = GrowResultArray(result->hints, &result->hintCapacity,
+                                        sizeof(ACStemHint));
+    hint = &result->hints[result->hintCount++];
+
+    switch (lst->c) {
+        case 'b':
+        case 'v':
+            hint->type = lst->c == 'b' ? AC_HStem : AC_HStem3;
+            hint->edge = lst->y0;
+            hint->width = lst->y1 - lst->y0;
+            break;
+        case 'y':
+        case 'm':
+            hint->type = lst->c == 'y' ? AC_VStem : AC_VStem3;
+            hint->edge = lst->x0;
+            hint->width = lst->x1 - lst->x0;
+            break;
+        default:
+            LogMsg(LOGERROR, NONFATALERROR, "Illegal point list data.");
+    }
+    hint->elements[0] = ElementIndex(lst->p0);
+    hint->elements[1] = ElementIndex(lst->p1);
+}
+
+static bool
+SameResultHints(const ACStemHint* h1, const ACStemHint* h2, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (h1[i].type != h2[i].type || h1[i].edge != h2[i].edge ||
+            h1[i].width != h2[i].width ||
+            h1[i].elements[0] != h2[i].elements[0] ||
+            h1[i].elements[1] != h2[i].elements[1])
+            return false;
+    }
+    return true;
+}
+
+/* Adds the hints of lst as a hint set starting at the path element e, unless
+ * they are the same as those of the previous set, as for bez data. */
+static void
+ResultHintSet(int32_t ix, PathElt* e)
+{
+    ACHintResult* result = gHintResult;
+    size_t first = result->hintCount, count;
+    ACHintSet* set;
+    HintPoint** pts;
+    int32_t i, cnt;
+
+    pts = SortedPntLst(ix, &cnt);
+    for (i = 0; i < cnt; i++)
+        ResultHint(pts[i]);
+    count = result->hintCount - first;
+
+    if (result->hintSetCount > 0) {
+        set = &result->hintSets[result->hintSetCount - 1];
+        if (set->count == count &&
+            SameResultHints(&result->hints[set->first],
+                            &result->hints[first], count)) {
+            result->hintCount = first;
+            return;
         }
-        bst->done = true; /* mark as having been done */
-        WritePointItem(bst);
+    } else if (count == 0) {
+        return;
+    }
+
+    if (result->hintSetCount == result->hintSetCapacity)
+        result->hintSets =
+          GrowResultArray(result->hintSets, &result->hintSetCapacity,
+                          sizeof(ACHintSet));
+    set = &result->hintSets[result->hintSetCount++];
+    set->element = (size_t)ElementIndex(e);
+    set->first = first;
+    set->count = count;
+}
+
+static void
+ResultElement(int op, int flags, Cd* c, int ncoords)
+{
+    ACHintResult* result = gHintResult;
+    ACPathElement* elt;
+    int i;
+
+    if (result->pathLength == result->pathCapacity)
+        result->path = GrowResultArray(result->path, &result->pathCapacity,
+                                       sizeof(ACPathElement));
+    elt = &result->path[result->pathLength++];
+
+    memset(elt, 0, sizeof(*elt));
+    elt->op = op;
+    elt->flags = flags;
+    /* the same rounding as in bez data */
+    for (i = 0; i < ncoords; i++) {
+        elt->coords[2 * i] = FRnd(c[i].x);
+        elt->coords[2 * i + 1] = FRnd(c[i].y);
     }
 }
 
@@ -222,11 +445,24 @@ wrtnewhints(PathElt* e)
     if (!wrtHintInfo) {
         return;
     }
-    hintmaskstr[0] = '\0';
-    WrtPntLst(gPtLstArray[e->newhints]);
-    if (strcmp(prevhintmaskstr, hintmaskstr)) {
-        WriteString("beginsubr snc\n%sendsubr enc\nnewcolors\n", hintmaskstr);
-        strcpy(prevhintmaskstr, hintmaskstr);
+    if (gHintResult) {
+        ResultHintSet(e->newhints, e);
+    }
+    /* the text only needs building if the hints differ from the last ones
+     * written */
+    if (prevPtLst >= 0 && SamePntLsts(prevPtLst, e->newhints)) {
+        return;
+    }
+    WrtPntLst(e->newhints);
+    prevPtLst = e->newhints;
+    if (hintmasklen != prevhintmasklen ||
+        memcmp(prevhintmaskstr, hintmaskstr, hintmasklen) != 0) {
+        WriteLiteral("beginsubr snc\n");
+        ACBufferWrite(gBezOutput, hintmaskstr, hintmasklen);
+        WriteLiteral("endsubr enc\nnewcolors\n");
+        CountStat(hintSets, 1);
+        memcpy(prevhintmaskstr, hintmaskstr, hintmasklen + 1);
+        prevhintmasklen = hintmasklen;
     }
 }
 
@@ -251,7 +487,7 @@ mt(Cd c, PathElt* e)
         wrtnewhints(e);
     }
     wrtcda(c);
-    WriteString("mt\n");
+    WriteLiteral("mt\n");
 }
 
 static void
@@ -261,15 +497,18 @@ dt(Cd c, PathElt* e)
         wrtnewhints(e);
     }
     wrtcda(c);
-    WriteString("dt\n");
+    WriteLiteral("dt\n");
 }
 
-static Fixed flX, flY;
-static Cd fc1, fc2, fc3;
+#define flX (gContext->write.flX)
+#define flY (gContext->write.flY)
+#define fc1 (gContext->write.fc1)
+#define fc2 (gContext->write.fc2)
+#define fc3 (gContext->write.fc3)
 
 #define wrtpreflx2a(c)                                                         \
     wrtcda(c);                                                                 \
-    WriteString("rmt\npreflx2a\n")
+    WriteLiteral("rmt\npreflx2a\n")
 
 static void
 wrtflex(Cd c1, Cd c2, Cd c3, PathElt* e)
@@ -290,7 +529,7 @@ wrtflex(Cd c1, Cd c2, Cd c3, PathElt* e)
     yflag = e->yFlex;
     dmin = gDMin;
     delta = gDelta;
-    WriteString("preflx1\n");
+    WriteLiteral("preflx1\n");
     if (yflag) {
         if (fc3.y == c3.y) {
             c13.y = c3.y;
@@ -345,23 +584,23 @@ wrtflex(Cd c1, Cd c2, Cd c3, PathElt* e)
     WRTNUM(yflag);
     WRTNUM(FTrunc(FRnd(currentx)));
     WRTNUM(FTrunc(FRnd(currenty)));
-    WriteString("flxa\n");
+    WriteLiteral("flxa\n");
     firstFlex = true;
 }
 
 static void
-ct(Cd c1, Cd c2, Cd c3, PathElt* e)
+ct(Cd c1, Cd c2, Cd c3, PathElt* e, bool flex)
 {
     if (e->newhints != 0) {
         wrtnewhints(e);
     }
-    if (e->isFlex && IsFlex(e)) {
+    if (flex) {
         wrtflex(c1, c2, c3, e);
     } else {
         wrtcda(c1);
         wrtcda(c2);
         wrtcda(c3);
-        WriteString("ct\n");
+        WriteLiteral("ct\n");
     }
 }
 
@@ -371,7 +610,7 @@ cp(PathElt* e)
     if (e->newhints != 0) {
         wrtnewhints(e);
     }
-    WriteString("cp\n");
+    WriteLiteral("cp\n");
 }
 
 static void
@@ -391,45 +630,71 @@ void
 SaveFile(void)
 {
     PathElt* e = gPathStart;
-    Cd c1, c2, c3;
+    Cd c[3];
+    bool flex;
 
     WriteString("%% %s\n", gGlyphName);
     wrtHintInfo = (gPathStart != NULL && gPathStart != gPathEnd);
     NumberPath();
     prevhintmaskstr[0] = '\0';
+    prevhintmasklen = 0;
+    prevPtLst = -1;
+    sortedLsts = (HintPoint***)Alloc(gNumPtLsts * sizeof(HintPoint**));
+    sortedCnts = (int32_t*)Alloc(gNumPtLsts * sizeof(int32_t));
+    if (gHintResult) {
+        strcpy(gHintResult->glyphName, gGlyphName);
+    }
     if (wrtHintInfo && (!e->newhints)) {
-        hintmaskstr[0] = '\0';
-        WrtPntLst(gPtLstArray[0]);
-        WriteString("%s", hintmaskstr);
-        strcpy(prevhintmaskstr, hintmaskstr);
+        WrtPntLst(0);
+        ACBufferWrite(gBezOutput, hintmaskstr, hintmasklen);
+        memcpy(prevhintmaskstr, hintmaskstr, hintmasklen + 1);
+        prevhintmasklen = hintmasklen;
+        prevPtLst = 0;
+        CountStat(hintSets, 1);
+        if (gHintResult) {
+            ResultHintSet(0, e);
+        }
     }
 
-    WriteString("sc\n");
+    WriteLiteral("sc\n");
     firstFlex = true;
     currentx = currenty = 0;
     while (e != NULL) {
         switch (e->type) {
             case CURVETO:
-                c1.x = e->x1;
-                c1.y = -e->y1;
-                c2.x = e->x2;
-                c2.y = -e->y2;
-                c3.x = e->x3;
-                c3.y = -e->y3;
-                ct(c1, c2, c3, e);
+                c[0].x = e->x1;
+                c[0].y = -e->y1;
+                c[1].x = e->x2;
+                c[1].y = -e->y2;
+                c[2].x = e->x3;
+                c[2].y = -e->y3;
+                flex = e->isFlex && IsFlex(e);
+                ct(c[0], c[1], c[2], e, flex);
+                if (gHintResult) {
+                    ResultElement(AC_CurveTo, flex ? AC_FlexCurve : 0, c, 3);
+                }
                 break;
             case LINETO:
-                c1.x = e->x;
-                c1.y = -e->y;
-                dt(c1, e);
+                c[0].x = e->x;
+                c[0].y = -e->y;
+                dt(c[0], e);
+                if (gHintResult) {
+                    ResultElement(AC_LineTo, 0, c, 1);
+                }
                 break;
             case MOVETO:
-                c1.x = e->x;
-                c1.y = -e->y;
-                mt(c1, e);
+                c[0].x = e->x;
+                c[0].y = -e->y;
+                mt(c[0], e);
+                if (gHintResult) {
+                    ResultElement(AC_MoveTo, 0, c, 1);
+                }
                 break;
             case CLOSEPATH:
                 cp(e);
+                if (gHintResult) {
+                    ResultElement(AC_ClosePath, 0, c, 0);
+                }
                 break;
             default: {
                 LogMsg(LOGERROR, NONFATALERROR, "Illegal path list.");
@@ -440,22 +705,22 @@ SaveFile(void)
         WRTNUM(e->count)
         switch (e->type) {
             case CURVETO:
-                wrtfx(c1.x);
-                wrtfx(c1.y);
-                wrtfx(c2.x);
-                wrtfx(c2.y);
-                wrtfx(c3.x);
-                wrtfx(c3.y);
+                wrtfx(c[0].x);
+                wrtfx(c[0].y);
+                wrtfx(c[1].x);
+                wrtfx(c[1].y);
+                wrtfx(c[2].x);
+                wrtfx(c[2].y);
                 WriteString("ct");
                 break;
             case LINETO:
-                wrtfx(c1.x);
-                wrtfx(c1.y);
+                wrtfx(c[0].x);
+                wrtfx(c[0].y);
                 WriteString("dt");
                 break;
             case MOVETO:
-                wrtfx(c1.x);
-                wrtfx(c1.y);
+                wrtfx(c[0].x);
+                wrtfx(c[0].y);
                 WriteString("mt");
                 break;
             case CLOSEPATH:
@@ -466,5 +731,5 @@ SaveFile(void)
 #endif
         e = e->next;
     }
-    WriteString("ed\n");
+    WriteLiteral("ed\n");
 }
@@ -51,7 +51,8 @@ def get_font_format(font_file_path):
 
 def hint_bez_glyph(info, glyph, allow_edit=True, allow_hint_sub=True,
                    round_coordinates=True, report_zones=False,
-                   report_stems=False, report_all_stems=False):
+                   report_stems=False, report_all_stems=False,
+                   log_records=None, stats=None):
     report = 0
     if report_zones:
         report = 1
@@ -64,7 +65,9 @@ def hint_bez_glyph(info, glyph, allow_edit=True, allow_hint_sub=True,
                                     allow_hint_sub,
                                     round_coordinates,
                                     report,
-                                    report_all_stems)
+                                    report_all_stems,
+                                    log_records,
+                                    stats)
     hinted = hinted_b.decode('ascii')
 
     return hinted
@@ -334,6 +334,7 @@ class HintOptions(ACOptions):
         self.printFDDictList = pargs.print_list_fddict
         self.round_coords = not pargs.decimal
         self.writeToDefaultLayer = pargs.write_to_default_layer
+        self.jobs = pargs.jobs
 
 
 class _CustomHelpFormatter(argparse.RawDescriptionHelpFormatter):
@@ -429,6 +430,17 @@ def _check_save_path(path_str):
     return test_path
 
 
+def _check_jobs(jobs_str):
+    try:
+        jobs = int(jobs_str)
+    except ValueError:
+        jobs = -1
+    if jobs < 0:
+        raise argparse.ArgumentTypeError(
+            f"{jobs_str} is not a valid number of jobs.")
+    return jobs
+
+
 def _check_tx():
     try:
         subprocess.check_output(["tx", "-h"], stderr=subprocess.STDOUT)
@@ -606,6 +618,15 @@ def get_options(args):
         action='store_true',
         help='process the font without modifying it'
     )
+    parser.add_argument(
+        '-j',
+        '--jobs',
+        metavar='N',
+        type=_check_jobs,
+        default=0,
+        help='number of glyphs to hint in parallel\n'
+             'Default: 0, one per CPU'
+    )
     parser.add_argument(
         '--log',
         metavar='PATH',
@@ -785,6 +806,7 @@ class ReportOptions(ACOptions):
         self.report_stems = not pargs.alignment_zones
         self.report_zones = pargs.alignment_zones
         self.report_all_stems = pargs.all_stems
+        self.jobs = pargs.jobs
 
 
 def get_stemhist_options(args):
@@ -883,6 +905,15 @@ def get_stemhist_options(args):
         help='verbose mode\n'
              'Use -vv for extra-verbose mode.'
     )
+    parser.add_argument(
+        '-j',
+        '--jobs',
+        metavar='N',
+        type=_check_jobs,
+        default=0,
+        help='number of glyphs to hint in parallel\n'
+             'Default: 0, one per CPU'
+    )
     parser.add_argument(
         '--version',
         action='version',
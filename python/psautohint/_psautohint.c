@@ -18,6 +18,7 @@
 #define PY_SSIZE_T_CLEAN 1
 #include <Python.h>
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,36 +26,190 @@
 
 #include "psautohint.h"
 
+/*
+ * The hinting itself runs without holding the GIL, so the messages reported
+ * while hinting a glyph can't go to the logger right away. They are kept in a
+ * per-thread buffer as (level, message) records instead, and logged once the
+ * GIL is held again.
+ */
+static Py_tss_t messagesKey = Py_tss_NEEDS_INIT;
+
 static void
 reportCB(char* msg, int level)
 {
-    static PyObject* logger = NULL;
+    ACBuffer* messages = PyThread_tss_get(&messagesKey);
+
+    if (messages == NULL)
+        return;
+
+    ACBufferWrite(messages, (char*)&level, sizeof(level));
+    ACBufferWrite(messages, msg, strlen(msg) + 1);
+}
+
+static PyObject* logger = NULL;
 
+/* Looks up the "_psautohint" logger, returns -1 if it fails. */
+static int
+getLogger(void)
+{
     if (logger == NULL) {
         PyObject* logging = PyImport_ImportModule("logging");
         if (logging == NULL)
-            return;
+            return -1;
         logger = PyObject_CallMethod(logging, "getLogger", "s", "_psautohint");
+        Py_DECREF(logging);
         if (logger == NULL)
-            return;
-    }
-
-    switch (level) {
-        case AC_LogDebug:
-            PyObject_CallMethod(logger, "debug", "s", msg);
-            break;
-        case AC_LogInfo:
-            PyObject_CallMethod(logger, "info", "s", msg);
-            break;
-        case AC_LogWarning:
-            PyObject_CallMethod(logger, "warning", "s", msg);
-            break;
-        case AC_LogError:
-            PyObject_CallMethod(logger, "error", "s", msg);
-            break;
-        default:
-            break;
+            return -1;
+    }
+    return 0;
+}
+
+/*
+ * Returns the lowest AC_Log* level that the logger would not drop, so that
+ * the library doesn't format the messages below it at all. This holds for
+ * log records too, as they are meant to be logged to the same logger later.
+ */
+static int
+logLevel(void)
+{
+    static const int levels[][2] = {
+        { AC_LogDebug, 10 }, { AC_LogInfo, 20 }, { AC_LogWarning, 30 }
+    };
+    size_t i;
+
+    if (getLogger() < 0) {
+        PyErr_Clear();
+        return AC_LogDebug;
+    }
+
+    for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        PyObject* enabled =
+          PyObject_CallMethod(logger, "isEnabledFor", "i", levels[i][1]);
+        int isTrue = enabled ? PyObject_IsTrue(enabled) : 1;
+        Py_XDECREF(enabled);
+        if (isTrue) {
+            PyErr_Clear();
+            return levels[i][0];
+        }
+    }
+    return AC_LogError;
+}
+
+/*
+ * Logs the buffered messages to the "_psautohint" logger or, if records is a
+ * list, appends them to it as (level, message) tuples so that the caller can
+ * log them later. The levels are those of the logging module.
+ */
+static int
+flushMessages(ACBuffer* messages, PyObject* records)
+{
+    char* data;
+    size_t len, i = 0;
+
+    if (records == NULL && getLogger() < 0)
+        return -1;
+
+    ACBufferRead(messages, &data, &len);
+    while (i < len) {
+        PyObject* result;
+        int level, pyLevel;
+        char* msg;
+
+        memcpy(&level, data + i, sizeof(level));
+        msg = data + i + sizeof(level);
+        i += sizeof(level) + strlen(msg) + 1;
+
+        switch (level) {
+            case AC_LogDebug:
+                pyLevel = 10;
+                break;
+            case AC_LogInfo:
+                pyLevel = 20;
+                break;
+            case AC_LogWarning:
+                pyLevel = 30;
+                break;
+            case AC_LogError:
+                pyLevel = 40;
+                break;
+            default:
+                continue;
+        }
+
+        if (records) {
+            PyObject* record = Py_BuildValue("(is)", pyLevel, msg);
+            if (record == NULL)
+                return -1;
+            if (PyList_Append(records, record) < 0) {
+                Py_DECREF(record);
+                return -1;
+            }
+            Py_DECREF(record);
+        } else {
+            result = PyObject_CallMethod(logger, "log", "is", pyLevel, msg);
+            if (result == NULL)
+                return -1;
+            Py_DECREF(result);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * A hinting context with the buffers for its output and messages. The ones
+ * that are not in use by any call are kept, so that they can be reused
+ * instead of allocating new ones for every glyph. Only touched with the GIL
+ * held.
+ */
+typedef struct
+{
+    ACContext* ctx;
+    ACBuffer* output;
+    ACBuffer* messages;
+} Hinter;
+
+#define MAXIDLEHINTERS 64
+static Hinter idleHinters[MAXIDLEHINTERS];
+static int numIdleHinters = 0;
+
+static void
+freeHinter(Hinter* hinter)
+{
+    ACContextFree(hinter->ctx);
+    ACBufferFree(hinter->output);
+    ACBufferFree(hinter->messages);
+}
+
+/* Fills hinter with empty buffers, returns -1 if out of memory. */
+static int
+getHinter(Hinter* hinter)
+{
+    if (numIdleHinters > 0) {
+        *hinter = idleHinters[--numIdleHinters];
+        ACBufferReset(hinter->output);
+        ACBufferReset(hinter->messages);
+        return 0;
+    }
+
+    hinter->ctx = ACContextNew();
+    hinter->output = ACBufferNew(4096);
+    hinter->messages = ACBufferNew(150);
+    if (!hinter->ctx || !hinter->output || !hinter->messages) {
+        freeHinter(hinter);
+        memset(hinter, 0, sizeof(Hinter));
+        return -1;
     }
+    return 0;
+}
+
+static void
+releaseHinter(Hinter* hinter)
+{
+    if (numIdleHinters < MAXIDLEHINTERS)
+        idleHinters[numIdleHinters++] = *hinter;
+    else
+        freeHinter(hinter);
 }
 
 static void
@@ -107,13 +262,63 @@ memoryManager(void* ctx, void* ptr, size_t size)
     return ptr;
 }
 
+/*
+ * Parsed font infos, keyed by the font info bytes. Python passes the same font
+ * info for all the glyphs of a font (or of an FDDict), so this saves parsing
+ * it again for every glyph. Only touched with the GIL held; each call keeps a
+ * reference to the font info it uses, so clearing the cache while another
+ * thread is hinting is safe.
+ */
+#define MAXCACHEDFONTINFOS 64
+static PyObject* fontInfoCache = NULL;
+
+static void
+freeFontInfo(PyObject* capsule)
+{
+    ACFontInfoFree(PyCapsule_GetPointer(capsule, "ACFontInfo"));
+}
+
+static PyObject*
+getFontInfo(PyObject* fontObj)
+{
+    PyObject* infoObj;
+    ACFontInfo* info;
+
+    infoObj = PyDict_GetItemWithError(fontInfoCache, fontObj);
+    if (infoObj) {
+        Py_INCREF(infoObj);
+        return infoObj;
+    }
+    if (PyErr_Occurred())
+        return NULL;
+
+    info = ACFontInfoNew(PyBytes_AS_STRING(fontObj));
+    if (!info)
+        return PyErr_NoMemory();
+    infoObj = PyCapsule_New(info, "ACFontInfo", freeFontInfo);
+    if (!infoObj) {
+        ACFontInfoFree(info);
+        return NULL;
+    }
+
+    if (PyDict_GET_SIZE(fontInfoCache) >= MAXCACHEDFONTINFOS)
+        PyDict_Clear(fontInfoCache);
+    if (PyDict_SetItem(fontInfoCache, fontObj, infoObj) < 0) {
+        Py_DECREF(infoObj);
+        return NULL;
+    }
+
+    return infoObj;
+}
+
 static PyObject* PsAutoHintError;
 
 static char autohint_doc[] =
   "Autohint glyphs.\n"
   "\n"
   "Signature:\n"
-  "  autohint(font_info, glyphs[, no_edit, allow_hint_sub, round])\n"
+  "  autohint(font_info, glyphs[, no_edit, allow_hint_sub, round, report,\n"
+  "           all_stems, log_records, stats, analytic_bbox])\n"
   "\n"
   "Args:\n"
   "  font_info: font information.\n"
@@ -121,6 +326,17 @@ static char autohint_doc[] =
   "  allow_edit: allow editing (changing) the paths when hinting.\n"
   "  allow_hint_sub: no multiple layers of coloring.\n"
   "  round: round coordinates.\n"
+  "  report: 1 to report zones, 2 to report stems instead of hinting.\n"
+  "  all_stems: include stems defined by curves when reporting stems.\n"
+  "  log_records: if a list, the messages of the hinting are appended to it\n"
+  "    as (level, message) tuples instead of being logged. The messages\n"
+  "    that the \"_psautohint\" logger would drop are left out.\n"
+  "  stats: if a dict, the time in nanoseconds spent in each phase of the\n"
+  "    hinting (the keys ending in \"_ns\") and some counts (\"segments\",\n"
+  "    \"candidate_values\", \"pruned_values\", \"hint_sets\", \"retries\"\n"
+  "    and \"arena_bytes\") are stored in it, with the glyph \"name\".\n"
+  "  analytic_bbox: find the bounding boxes of curves from their extremes\n"
+  "    instead of by flattening them.\n"
   "\n"
   "Output:\n"
   "  Autohinted glyph data in bez format.\n"
@@ -128,98 +344,491 @@ static char autohint_doc[] =
   "Raises:\n"
   "  psautohint.error: If autohinting fails.\n";
 
+/* The glyph to hint, either bez data or a path. */
+typedef struct
+{
+    const char* bez;
+    const char* name;
+    const ACPathElement* path;
+    size_t pathLength;
+} GlyphInput;
+
+static PyObject* resultToPython(const ACHintResult* result);
+
+/* Stores the stats in the dictionary dict, returns -1 if it fails. */
+static int
+statsToPython(const ACStats* stats, PyObject* dict)
+{
+    struct
+    {
+        const char* key;
+        unsigned long long value;
+    } items[] = {
+        { "read_glyph_ns", stats->readGlyphNs },
+        { "pre_gen_pts_ns", stats->preGenPtsNs },
+        { "gen_h_pts_ns", stats->genHPtsNs },
+        { "gen_v_pts_ns", stats->genVPtsNs },
+        { "eval_h_ns", stats->evalHNs },
+        { "eval_v_ns", stats->evalVNs },
+        { "prune_h_vals_ns", stats->pruneHValsNs },
+        { "prune_v_vals_ns", stats->pruneVValsNs },
+        { "merge_vals_ns", stats->mergeValsNs },
+        { "auto_extra_hints_ns", stats->autoExtraHintsNs },
+        { "shuffle_subpaths_ns", stats->shuffleSubpathsNs },
+        { "save_file_ns", stats->saveFileNs },
+        { "segments", stats->segments },
+        { "candidate_values", stats->candidateValues },
+        { "pruned_values", stats->prunedValues },
+        { "hint_sets", stats->hintSets },
+        { "retries", stats->retries },
+        { "arena_bytes", stats->arenaBytes },
+    };
+    PyObject* name;
+    size_t i;
+
+    for (i = 0; i < sizeof(items) / sizeof(items[0]); i++) {
+        PyObject* value = PyLong_FromUnsignedLongLong(items[i].value);
+        int failed = !value || PyDict_SetItemString(dict, items[i].key, value);
+        Py_XDECREF(value);
+        if (failed)
+            return -1;
+    }
+
+    name = PyUnicode_FromString(stats->glyphName);
+    if (!name || PyDict_SetItemString(dict, "name", name) < 0) {
+        Py_XDECREF(name);
+        return -1;
+    }
+    Py_DECREF(name);
+    return 0;
+}
+
+/* Hints glyph, returning the hinted bez data, or the report if report is
+ * set, or hintResult converted by resultToPython() if it is not NULL. If
+ * statsObj is a dictionary, the stats of the call are stored in it. */
 static PyObject*
-autohint(PyObject* self, PyObject* args)
+hintGlyph(PyObject* fontObj, const GlyphInput* glyph, int allowEdit,
+          int allowHintSub, int roundCoords, int report, int allStems,
+          PyObject* records, PyObject* statsObj, int analyticBBox,
+          ACHintResult* hintResult)
 {
-    int allowEdit = true, roundCoords = true, allowHintSub = true;
-    int report = 0, allStems = false;
-    PyObject* fontObj = NULL;
-    PyObject* inObj = NULL;
     PyObject* outObj = NULL;
-    char* inData = NULL;
-    char* fontInfo = NULL;
     bool error = true;
+    int result = -1;
     ACBuffer* reportBuffer = NULL;
+    Hinter hinter;
+    PyObject* infoObj = NULL;
+    ACStats stats;
 
-    if (!PyArg_ParseTuple(args, "O!O!|iiiii", &PyBytes_Type, &fontObj,
-                          &PyBytes_Type, &inObj, &allowEdit, &allowHintSub,
-                          &roundCoords, &report, &allStems))
+    if (records == Py_None) {
+        records = NULL;
+    } else if (!PyList_Check(records)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "\"log_records\" argument must be a list or None");
         return NULL;
+    }
+
+    if (statsObj == Py_None) {
+        statsObj = NULL;
+    } else if (!PyDict_Check(statsObj)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "\"stats\" argument must be a dict or None");
+        return NULL;
+    }
 
     if (report) {
+        if (report != 1 && report != 2) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Invalid \"report\" argument, must be 1 or 2");
+            return NULL;
+        }
         reportBuffer = ACBufferNew(150);
         allowEdit = allowHintSub = false;
-        switch (report) {
-            case 1:
-                AC_SetReportRetryCB(reportRetry, (void*)reportBuffer);
-                AC_SetReportZonesCB(charZoneCB, stemZoneCB,
-                                    (void*)reportBuffer);
+    }
+
+    if (getHinter(&hinter) < 0) {
+        PyErr_NoMemory();
+    } else {
+        ACContext* ctx = hinter.ctx;
+        ACContextSetLogLevel(ctx, logLevel());
+        if (report) {
+            ACContextSetReportRetryCB(ctx, reportRetry, (void*)reportBuffer);
+            if (report == 1)
+                ACContextSetReportZonesCB(ctx, charZoneCB, stemZoneCB,
+                                          (void*)reportBuffer);
+            else
+                ACContextSetReportStemsCB(ctx, hstemCB, vstemCB, allStems,
+                                          (void*)reportBuffer);
+        }
+        ACBufferReserve(hinter.output, glyph->bez ? 4 * strlen(glyph->bez)
+                                                  : 64 * glyph->pathLength);
+        PyThread_tss_set(&messagesKey, hinter.messages);
+        infoObj = getFontInfo(fontObj);
+        if (infoObj) {
+            const ACFontInfo* info = PyCapsule_GetPointer(infoObj, "ACFontInfo");
+            ACContextSetHintResult(ctx, hintResult);
+            ACContextSetAnalyticBBox(ctx, analyticBBox);
+            if (statsObj)
+                ACContextSetStats(ctx, &stats);
+            Py_BEGIN_ALLOW_THREADS
+            if (glyph->bez)
+                result = AutoHintStringWithInfo(ctx, glyph->bez, info,
+                                                hinter.output, allowEdit,
+                                                allowHintSub, roundCoords);
+            else
+                result = AutoHintPath(ctx, glyph->name, glyph->path,
+                                      glyph->pathLength, info, hinter.output,
+                                      allowEdit, allowHintSub, roundCoords);
+            Py_END_ALLOW_THREADS
+            ACContextSetHintResult(ctx, NULL);
+            ACContextSetStats(ctx, NULL);
+        }
+        PyThread_tss_set(&messagesKey, NULL);
+
+        if (infoObj && flushMessages(hinter.messages, records) < 0)
+            result = -1;
+
+        if (result == AC_Success && statsObj &&
+            statsToPython(&stats, statsObj) < 0)
+            result = -1;
+
+        if (result == AC_Success) {
+            char* data;
+            size_t len;
+            if (reportBuffer) {
+                ACBufferRead(reportBuffer, &data, &len);
+                outObj = PyBytes_FromStringAndSize(data, len);
+            } else if (hintResult) {
+                outObj = resultToPython(hintResult);
+            } else {
+                ACBufferRead(hinter.output, &data, &len);
+                outObj = PyBytes_FromStringAndSize(data, len);
+            }
+            error = outObj == NULL;
+        }
+        /* clear out references to reportBuffer */
+        ACContextResetCallbacks(ctx);
+        releaseHinter(&hinter);
+    }
+    Py_XDECREF(infoObj);
+
+    if (result != AC_Success) {
+        switch (result) {
+            case -1:
+                /* Do nothing, we already called PyErr_* */
+                break;
+            case AC_FatalError:
+                PyErr_SetString(PsAutoHintError, "Fatal error");
                 break;
-            case 2:
-                AC_SetReportRetryCB(reportRetry, (void*)reportBuffer);
-                AC_SetReportStemsCB(hstemCB, vstemCB, allStems,
-                                    (void*)reportBuffer);
+            case AC_InvalidParameterError:
+                PyErr_SetString(PyExc_ValueError, "Invalid glyph data");
                 break;
+            case AC_UnknownError:
             default:
-                PyErr_SetString(PyExc_ValueError,
-                                "Invalid \"report\" argument, must be 1 or 2");
-                goto done;
+                PyErr_SetString(PsAutoHintError, "Hinting failed");
+                break;
         }
     }
 
-    AC_SetMemManager(NULL, memoryManager);
-    AC_SetReportCB(reportCB);
+    ACBufferFree(reportBuffer);
 
-    fontInfo = PyBytes_AsString(fontObj);
-    inData = PyBytes_AsString(inObj);
-    if (inData && fontInfo) {
-        int result = -1;
+    if (error)
+        return NULL;
+    return outObj;
+}
+
+static PyObject*
+autohint(PyObject* self, PyObject* args)
+{
+    int allowEdit = true, roundCoords = true, allowHintSub = true;
+    int report = 0, allStems = false;
+    PyObject* fontObj = NULL;
+    PyObject* inObj = NULL;
+    PyObject* records = Py_None;
+    PyObject* statsObj = Py_None;
+    int analyticBBox = false;
+    GlyphInput glyph = { NULL, NULL, NULL, 0 };
 
-        ACBuffer* output = ACBufferNew(4 * strlen(inData));
-        if (output) {
-            result = AutoHintString(inData, fontInfo, output, allowEdit,
-                                    allowHintSub, roundCoords);
+    if (!PyArg_ParseTuple(args, "O!O!|iiiiiOOi", &PyBytes_Type, &fontObj,
+                          &PyBytes_Type, &inObj, &allowEdit, &allowHintSub,
+                          &roundCoords, &report, &allStems, &records,
+                          &statsObj, &analyticBBox))
+        return NULL;
 
-            if (result == AC_Success) {
-                char* data;
-                size_t len;
-                error = false;
-                if (reportBuffer)
-                    ACBufferRead(reportBuffer, &data, &len);
-                else
-                    ACBufferRead(output, &data, &len);
-                outObj = PyBytes_FromStringAndSize(data, len);
-            }
+    glyph.bez = PyBytes_AsString(inObj);
+    if (!glyph.bez)
+        return NULL;
+
+    return hintGlyph(fontObj, &glyph, allowEdit, allowHintSub, roundCoords,
+                     report, allStems, records, statsObj, analyticBBox, NULL);
+}
+
+static char autohintpath_doc[] =
+  "Autohint a glyph given as a path.\n"
+  "\n"
+  "Signature:\n"
+  "  autohintpath(font_info, glyph_name, path[, allow_edit, allow_hint_sub,\n"
+  "               round, report, all_stems, log_records, stats])\n"
+  "\n"
+  "Args:\n"
+  "  font_info: font information.\n"
+  "  glyph_name: name of the glyph.\n"
+  "  path: sequence of (operator, coordinates...) tuples, the operators\n"
+  "    being \"mt\" (x, y), \"dt\" (x, y), \"ct\" (x1, y1, x2, y2, x3, y3)\n"
+  "    and \"cp\", with absolute coordinates as in bez data.\n"
+  "  The other arguments are the same as for autohint().\n"
+  "\n"
+  "Output:\n"
+  "  Autohinted glyph data in bez format.\n"
+  "\n"
+  "Raises:\n"
+  "  psautohint.error: If autohinting fails.\n";
+
+/* indexed by the AC_MoveTo etc. path operators */
+static const char* pathOps[] = { "mt", "dt", "ct", "cp" };
+static const int pathOpCoords[] = { 2, 2, 6, 0 };
+
+/* Converts a sequence of path tuples to path elements, returns NULL with an
+ * exception set if it fails. The elements are to be freed with PyMem_Free. */
+static ACPathElement*
+convertPath(PyObject* pathObj, size_t* length)
+{
+    PyObject* seq;
+    ACPathElement* path;
+    Py_ssize_t i, n;
+
+    seq = PySequence_Fast(pathObj, "\"path\" argument must be a sequence");
+    if (!seq)
+        return NULL;
+
+    n = PySequence_Fast_GET_SIZE(seq);
+    path = PyMem_New(ACPathElement, n > 0 ? n : 1);
+    if (!path) {
+        Py_DECREF(seq);
+        return (ACPathElement*)PyErr_NoMemory();
+    }
+
+    for (i = 0; i < n; i++) {
+        PyObject* item = PySequence_Fast_GET_ITEM(seq, i);
+        const char* op = NULL;
+        Py_ssize_t size;
+        int j;
+
+        if (PyTuple_Check(item) && PyTuple_GET_SIZE(item) > 0 &&
+            PyUnicode_Check(PyTuple_GET_ITEM(item, 0)))
+            op = PyUnicode_AsUTF8(PyTuple_GET_ITEM(item, 0));
+        if (!op) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_TypeError,
+                                "path elements must be tuples starting with "
+                                "the operator");
+            goto error;
         }
-        ACBufferFree(output);
-        output=NULL;
 
-        if (result != AC_Success) {
-            switch (result) {
-                case -1:
-                    /* Do nothing, we already called PyErr_* */
-                    break;
-                case AC_FatalError:
-                    PyErr_SetString(PsAutoHintError, "Fatal error");
-                    break;
-                case AC_InvalidParameterError:
-                    PyErr_SetString(PyExc_ValueError, "Invalid glyph data");
-                    break;
-                case AC_UnknownError:
-                default:
-                    PyErr_SetString(PsAutoHintError, "Hinting failed");
-                    break;
+        for (j = 0; j < (int)(sizeof(pathOps) / sizeof(pathOps[0])); j++) {
+            if (strcmp(op, pathOps[j]) == 0)
+                break;
+        }
+        if (j == (int)(sizeof(pathOps) / sizeof(pathOps[0]))) {
+            PyErr_Format(PyExc_ValueError, "Unknown path operator \"%s\"",
+                         op);
+            goto error;
+        }
+
+        size = PyTuple_GET_SIZE(item) - 1;
+        if (size != pathOpCoords[j]) {
+            PyErr_Format(PyExc_ValueError,
+                         "Path operator \"%s\" takes %d coordinates, not %zd",
+                         op, pathOpCoords[j], size);
+            goto error;
+        }
+
+        memset(&path[i], 0, sizeof(path[i]));
+        path[i].op = j;
+        for (j = 0; j < size; j++) {
+            double value = PyFloat_AsDouble(PyTuple_GET_ITEM(item, j + 1));
+            float rounded;
+            if (value == -1.0 && PyErr_Occurred())
+                goto error;
+            if (!(value > -8388608.0 && value < 8388608.0)) {
+                PyErr_SetString(PyExc_ValueError,
+                                "Path coordinate out of range");
+                goto error;
             }
+            /* Rounded to 24.8 fixed point the same way as numbers in bez
+             * data, so that both give the same hints. */
+            rounded = roundf((float)value * 100) / 100;
+            path[i].coords[j] = (int32_t)(rounded * 256.0f);
+        }
+    }
+
+    Py_DECREF(seq);
+    *length = (size_t)n;
+    return path;
+
+error:
+    Py_DECREF(seq);
+    PyMem_Free(path);
+    return NULL;
+}
+
+static PyObject*
+autohintpath(PyObject* self, PyObject* args)
+{
+    int allowEdit = true, roundCoords = true, allowHintSub = true;
+    int report = 0, allStems = false;
+    PyObject* fontObj = NULL;
+    PyObject* pathObj = NULL;
+    PyObject* records = Py_None;
+    PyObject* statsObj = Py_None;
+    PyObject* outObj;
+    ACPathElement* path;
+    GlyphInput glyph = { NULL, NULL, NULL, 0 };
+
+    if (!PyArg_ParseTuple(args, "O!sO|iiiiiOO", &PyBytes_Type, &fontObj,
+                          &glyph.name, &pathObj, &allowEdit, &allowHintSub,
+                          &roundCoords, &report, &allStems, &records,
+                          &statsObj))
+        return NULL;
+
+    path = convertPath(pathObj, &glyph.pathLength);
+    if (!path)
+        return NULL;
+    glyph.path = path;
+
+    outObj = hintGlyph(fontObj, &glyph, allowEdit, allowHintSub, roundCoords,
+                       report, allStems, records, statsObj, false, NULL);
+    PyMem_Free(path);
+
+    return outObj;
+}
+
+static char autohintresult_doc[] =
+  "Autohint a glyph, returning the result in structured form.\n"
+  "\n"
+  "Signature:\n"
+  "  autohintresult(font_info, glyph[, allow_edit, allow_hint_sub, round,\n"
+  "                 log_records, stats])\n"
+  "\n"
+  "Args:\n"
+  "  The same as for autohint().\n"
+  "\n"
+  "Output:\n"
+  "  A dictionary with the keys:\n"
+  "    name: the glyph name.\n"
+  "    hints: list of (type, edge, width, element0, element1) tuples, type\n"
+  "      being \"hstem\", \"vstem\", \"hstem3\" or \"vstem3\", and the\n"
+  "      elements the path indexes the hint was made for (-1 if none).\n"
+  "    hint_sets: list of (element, first, count) tuples, the hints[first]\n"
+  "      to hints[first + count - 1] being used from the path element with\n"
+  "      the index element on.\n"
+  "    path: the hinted path, as for autohintpath().\n"
+  "    flex: indexes of the path elements that are curves of a flex.\n"
+  "\n"
+  "Raises:\n"
+  "  psautohint.error: If autohinting fails.\n";
+
+static const char* hintTypes[] = { "hstem", "vstem", "hstem3", "vstem3" };
+
+static PyObject*
+resultToPython(const ACHintResult* result)
+{
+    PyObject* hints = PyList_New(result->hintCount);
+    PyObject* hintSets = PyList_New(result->hintSetCount);
+    PyObject* path = PyList_New(result->pathLength);
+    PyObject* flex = PyList_New(0);
+    PyObject* dict = NULL;
+    size_t i;
+
+    if (!hints || !hintSets || !path || !flex)
+        goto done;
+
+    for (i = 0; i < result->hintCount; i++) {
+        const ACStemHint* hint = &result->hints[i];
+        PyObject* item = Py_BuildValue(
+          "(sddii)", hintTypes[hint->type], hint->edge / 256.0,
+          hint->width / 256.0, (int)hint->elements[0],
+          (int)hint->elements[1]);
+        if (!item)
+            goto done;
+        PyList_SET_ITEM(hints, i, item);
+    }
+
+    for (i = 0; i < result->hintSetCount; i++) {
+        const ACHintSet* set = &result->hintSets[i];
+        PyObject* item = Py_BuildValue("(nnn)", (Py_ssize_t)set->element,
+                                       (Py_ssize_t)set->first,
+                                       (Py_ssize_t)set->count);
+        if (!item)
+            goto done;
+        PyList_SET_ITEM(hintSets, i, item);
+    }
+
+    for (i = 0; i < result->pathLength; i++) {
+        const ACPathElement* elt = &result->path[i];
+        PyObject* item = PyTuple_New(1 + pathOpCoords[elt->op]);
+        int j;
+        if (!item)
+            goto done;
+        PyList_SET_ITEM(path, i, item);
+        for (j = 0; j < PyTuple_GET_SIZE(item); j++) {
+            PyObject* value =
+              j == 0 ? PyUnicode_FromString(pathOps[elt->op])
+                     : PyFloat_FromDouble(elt->coords[j - 1] / 256.0);
+            if (!value)
+                goto done;
+            PyTuple_SET_ITEM(item, j, value);
+        }
+        if (elt->flags & AC_FlexCurve) {
+            PyObject* index = PyLong_FromSize_t(i);
+            int failed = !index || PyList_Append(flex, index) < 0;
+            Py_XDECREF(index);
+            if (failed)
+                goto done;
         }
     }
 
+    dict = Py_BuildValue("{s:s,s:O,s:O,s:O,s:O}", "name", result->glyphName,
+                         "hints", hints, "hint_sets", hintSets, "path", path,
+                         "flex", flex);
+
 done:
-    ACBufferFree(reportBuffer);
-    reportBuffer = NULL;
-    AC_initCallGlobals(); /* clear out references to reportBuffer */
+    Py_XDECREF(hints);
+    Py_XDECREF(hintSets);
+    Py_XDECREF(path);
+    Py_XDECREF(flex);
+    return dict;
+}
 
-    if (error)
+static PyObject*
+autohintresult(PyObject* self, PyObject* args)
+{
+    int allowEdit = true, roundCoords = true, allowHintSub = true;
+    PyObject* fontObj = NULL;
+    PyObject* inObj = NULL;
+    PyObject* records = Py_None;
+    PyObject* statsObj = Py_None;
+    PyObject* outObj;
+    ACHintResult* result;
+    GlyphInput glyph = { NULL, NULL, NULL, 0 };
+
+    if (!PyArg_ParseTuple(args, "O!O!|iiiOO", &PyBytes_Type, &fontObj,
+                          &PyBytes_Type, &inObj, &allowEdit, &allowHintSub,
+                          &roundCoords, &records, &statsObj))
         return NULL;
+
+    glyph.bez = PyBytes_AsString(inObj);
+    if (!glyph.bez)
+        return NULL;
+
+    result = ACHintResultNew();
+    if (!result)
+        return PyErr_NoMemory();
+
+    outObj = hintGlyph(fontObj, &glyph, allowEdit, allowHintSub, roundCoords,
+                       0, false, records, statsObj, false, result);
+    ACHintResultFree(result);
+
     return outObj;
 }
 
@@ -282,16 +891,14 @@ autohintmm(PyObject* self, PyObject* args)
             goto done;
     }
 
-    AC_SetMemManager(NULL, memoryManager);
-    AC_SetReportCB(reportCB);
-
     outSeq = PyTuple_New(inCount);
     if (outSeq) {
         int result = -1;
 
         const char** inGlyphs = PyMem_RawCalloc(inCount, sizeof(char*));
         ACBuffer** outGlyphs = PyMem_RawCalloc(inCount, sizeof(ACBuffer*));
-        if (!inGlyphs || !outGlyphs) {
+        Hinter hinter = { NULL, NULL, NULL };
+        if (!inGlyphs || !outGlyphs || getHinter(&hinter) < 0) {
             PyErr_NoMemory();
             goto finish;
         }
@@ -304,7 +911,17 @@ autohintmm(PyObject* self, PyObject* args)
             outGlyphs[i] = ACBufferNew(4 * strlen(inGlyphs[i]));
         }
 
-        result = AutoHintStringMM(inGlyphs, mastersCount, masters, outGlyphs);
+        ACContextSetLogLevel(hinter.ctx, logLevel());
+        PyThread_tss_set(&messagesKey, hinter.messages);
+        Py_BEGIN_ALLOW_THREADS
+        result = AutoHintStringMMCtx(hinter.ctx, inGlyphs, mastersCount,
+                                     masters, outGlyphs);
+        Py_END_ALLOW_THREADS
+        PyThread_tss_set(&messagesKey, NULL);
+
+        if (flushMessages(hinter.messages, NULL) < 0)
+            result = -1;
+
         if (result == AC_Success) {
             error = false;
             for (i = 0; i < inCount; i++) {
@@ -326,6 +943,8 @@ autohintmm(PyObject* self, PyObject* args)
             }
         }
 
+        if (hinter.ctx)
+            releaseHinter(&hinter);
         PyMem_RawFree(inGlyphs);
         PyMem_RawFree(outGlyphs);
 
@@ -359,10 +978,120 @@ done:
     return outSeq;
 }
 
+static char autohintbatch_doc[] =
+  "Autohint glyphs on a pool of threads.\n"
+  "\n"
+  "Signature:\n"
+  "  autohintbatch(font_info, glyphs[, allow_edit, allow_hint_sub, round,\n"
+  "                threads])\n"
+  "\n"
+  "Args:\n"
+  "  font_info: font information.\n"
+  "  glyphs: tuple of glyph data in bez format.\n"
+  "  allow_edit: allow editing (changing) the paths when hinting.\n"
+  "  allow_hint_sub: no multiple layers of coloring.\n"
+  "  round: round coordinates.\n"
+  "  threads: number of threads, one per processor if 0 or less.\n"
+  "\n"
+  "Output:\n"
+  "  Tuple with a (status, hinted glyph) tuple for each glyph. status is 0\n"
+  "  if the glyph was hinted, otherwise the hinted glyph is None. The\n"
+  "  messages of the hinting are not logged.\n"
+  "\n"
+  "Raises:\n"
+  "  psautohint.error: If the batch can't be run.\n";
+
+static PyObject*
+autohintbatch(PyObject* self, PyObject* args)
+{
+    PyObject* fontObj = NULL;
+    PyObject* inObj = NULL;
+    int allowEdit = true, allowHintSub = true, roundCoords = true;
+    int nthreads = 0;
+    PyObject* infoObj = NULL;
+    PyObject* outSeq = NULL;
+    const char** inGlyphs = NULL;
+    ACBuffer** outGlyphs = NULL;
+    int* status = NULL;
+    int result = AC_FatalError;
+    Py_ssize_t inCount, i;
+
+    if (!PyArg_ParseTuple(args, "O!O!|iiii", &PyBytes_Type, &fontObj,
+                          &PyTuple_Type, &inObj, &allowEdit, &allowHintSub,
+                          &roundCoords, &nthreads))
+        return NULL;
+
+    inCount = PyTuple_GET_SIZE(inObj);
+    inGlyphs = PyMem_RawCalloc(inCount + 1, sizeof(char*));
+    outGlyphs = PyMem_RawCalloc(inCount + 1, sizeof(ACBuffer*));
+    status = PyMem_RawCalloc(inCount + 1, sizeof(int));
+    if (!inGlyphs || !outGlyphs || !status) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (i = 0; i < inCount; i++) {
+        inGlyphs[i] = PyBytes_AsString(PyTuple_GET_ITEM(inObj, i));
+        if (!inGlyphs[i])
+            goto done;
+        outGlyphs[i] = ACBufferNew(4 * strlen(inGlyphs[i]) + 1);
+    }
+
+    infoObj = getFontInfo(fontObj);
+    if (!infoObj)
+        goto done;
+
+    /* Nobody listens to the messages of the worker threads, which only get
+     * the errors (see the module init). */
+    Py_BEGIN_ALLOW_THREADS
+    result = AutoHintBatch(inGlyphs, inCount,
+                           PyCapsule_GetPointer(infoObj, "ACFontInfo"),
+                           outGlyphs, status, nthreads, allowEdit,
+                           allowHintSub, roundCoords);
+    Py_END_ALLOW_THREADS
+
+    if (result != AC_Success) {
+        PyErr_SetString(PsAutoHintError, "Hinting failed");
+        goto done;
+    }
+
+    outSeq = PyTuple_New(inCount);
+    for (i = 0; outSeq && i < inCount; i++) {
+        PyObject* item;
+        if (status[i] == AC_Success) {
+            char* data;
+            size_t len;
+            ACBufferRead(outGlyphs[i], &data, &len);
+            item = Py_BuildValue("(iy#)", status[i], data, (Py_ssize_t)len);
+        } else {
+            item = Py_BuildValue("(iO)", status[i], Py_None);
+        }
+        if (!item)
+            Py_CLEAR(outSeq);
+        else
+            PyTuple_SET_ITEM(outSeq, i, item);
+    }
+
+done:
+    Py_XDECREF(infoObj);
+    if (outGlyphs) {
+        for (i = 0; i < inCount; i++)
+            ACBufferFree(outGlyphs[i]);
+    }
+    PyMem_RawFree(inGlyphs);
+    PyMem_RawFree(outGlyphs);
+    PyMem_RawFree(status);
+
+    return outSeq;
+}
+
 /* clang-format off */
 static PyMethodDef psautohint_methods[] = {
   { "autohint", autohint, METH_VARARGS, autohint_doc },
   { "autohintmm", autohintmm, METH_VARARGS, autohintmm_doc },
+  { "autohintbatch", autohintbatch, METH_VARARGS, autohintbatch_doc },
+  { "autohintpath", autohintpath, METH_VARARGS, autohintpath_doc },
+  { "autohintresult", autohintresult, METH_VARARGS, autohintresult_doc },
   { NULL, NULL, 0, NULL }
 };
 /* clang-format on */
@@ -370,7 +1099,10 @@ static PyMethodDef psautohint_methods[] = {
 static char psautohint_doc[] =
   "Python wrapper for Adobe's PostScrupt autohinter.\n"
   "\n"
-  "autohint() -- Autohint glyphs.\n";
+  "autohint() -- Autohint glyphs.\n"
+  "autohintpath() -- Autohint a glyph given as a path.\n"
+  "autohintresult() -- Autohint a glyph, returning a structured result.\n"
+  "autohintbatch() -- Autohint glyphs on a pool of threads.\n";
 
 #define SETUPMODULE                                                            \
     PyModule_AddStringConstant(m, "version", AC_getVersion());                 \
@@ -401,6 +1133,27 @@ PyInit__psautohint(void)
     if (m == NULL)
         return NULL;
 
+    if (PyThread_tss_create(&messagesKey) != 0) {
+        Py_DECREF(m);
+        return PyErr_NoMemory();
+    }
+
+    fontInfoCache = PyDict_New();
+    if (fontInfoCache == NULL) {
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    /* PyMem_Raw* can be used without holding the GIL. */
+    AC_SetMemManager(NULL, memoryManager);
+
+    /* The defaults of every context. reportCB only keeps messages for the
+     * thread that is in a call, and each call sets the level of its own
+     * context, so only the errors of parsing font infos and of
+     * autohintbatch() get formatted with these. */
+    AC_SetReportCB(reportCB);
+    AC_SetLogLevel(AC_LogError);
+
     SETUPMODULE
 
     return m;
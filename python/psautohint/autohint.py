@@ -34,6 +34,7 @@ import os
 import sys
 import time
 from collections import defaultdict, namedtuple
+from concurrent.futures import ThreadPoolExecutor
 
 from .otfFont import CFFFontData
 from .ufoFont import UFOFontData
@@ -71,6 +72,8 @@ class ACOptions(object):
         self.report_zones = False
         self.report_stems = False
         self.report_all_stems = False
+        # number of glyphs hinted in parallel, 0 for one per CPU
+        self.jobs = 0
 
     def __str__(self):
         # used only when debugging.
@@ -577,12 +580,12 @@ class MMHintInfo:
         return len(self.bad_hint_idxs) > 0
 
 
-def hint_glyph(options, name, bez_glyph, fontinfo):
+def hint_glyph(options, name, bez_glyph, fontinfo, log_records=None):
     try:
         hinted = hint_bez_glyph(fontinfo, bez_glyph, options.allowChanges,
                                 not options.noHintSub, options.round_coords,
                                 options.report_zones, options.report_stems,
-                                options.report_all_stems)
+                                options.report_all_stems, log_records)
     except PsAutoHintCError:
         raise ACHintError("%s: Failure in processing outline data." %
                           options.nameAliases.get(name, name))
@@ -637,18 +640,76 @@ def hint_compatible_glyphs(options, name, bez_glyphs, masters, fontinfo):
     return hinted
 
 
+class _HintResult:
+    def __init__(self, hinted, records, error):
+        self.hinted = hinted
+        self.records = records
+        self.error = error
+
+    def get(self):
+        """
+        Logs the messages of the hinting library for the glyph, then returns
+        the hinted glyph or raises the error hinting it.
+        """
+        c_log = logging.getLogger("_psautohint")
+        for level, msg in self.records:
+            c_log.log(level, msg)
+        if self.error is not None:
+            raise self.error
+        return self.hinted
+
+
+def _hint_glyph_chunk(options, chunk):
+    # Runs on a worker thread of _hint_glyphs(), nothing is logged here.
+    results = []
+    for name, bez_glyph, fontinfo in chunk:
+        records = []
+        try:
+            hinted = hint_glyph(options, name, bez_glyph, fontinfo, records)
+        except ACHintError as err:
+            results.append(_HintResult(None, records, err))
+            break
+        results.append(_HintResult(hinted, records, None))
+    return results
+
+
+def _hint_glyphs(options, glyphs, fontinfo_list):
+    """
+    Hints the (name, bez glyph) pairs of glyphs using options.jobs threads,
+    and yields (name, _HintResult) pairs in the same order. The hinting
+    library releases the GIL, so the glyphs are hinted in parallel while the
+    caller handles the results and the log messages as in a sequential run.
+    """
+    jobs = options.jobs or os.cpu_count() or 1
+    # Hand the glyphs to the threads in chunks to keep the overhead per glyph
+    # low, but small enough for all threads to stay busy until the end.
+    size = max(1, min(32, len(glyphs) // (jobs * 4)))
+    chunks = [[(name, bez_glyph, fontinfo_list[name][0])
+               for name, bez_glyph in glyphs[i:i + size]]
+              for i in range(0, len(glyphs), size)]
+
+    with ThreadPoolExecutor(max_workers=jobs) as executor:
+        futures = [executor.submit(_hint_glyph_chunk, options, chunk)
+                   for chunk in chunks]
+        try:
+            for chunk, future in zip(chunks, futures):
+                for (name, _, _), result in zip(chunk, future.result()):
+                    yield name, result
+        except BaseException:
+            # Don't wait for the glyphs that haven't been started yet.
+            for future in futures:
+                future.cancel()
+            raise
+
+
 def get_glyph_reports(options, font, glyph_list, fontinfo_list):
     reports = GlyphReports()
 
     glyphs = get_bez_glyphs(options, font, glyph_list)
-    for name in glyphs:
-        if name == ".notdef":
-            continue
-
-        bez_glyph = glyphs[name][0]
-        fontinfo = fontinfo_list[name][0]
-
-        report = hint_glyph(options, name, bez_glyph, fontinfo)
+    glyphs = [(name, glyphs[name].bez_data) for name in glyphs
+              if name != ".notdef"]
+    for name, result in _hint_glyphs(options, glyphs, fontinfo_list):
+        report = result.get()
         reports.addGlyphReport(name, report.strip())
 
     return reports
@@ -662,8 +723,8 @@ def hint_font(options, font, glyph_list, fontinfo_list):
 
     hinted = {}
     glyphs = get_bez_glyphs(options, font, glyph_list)
-    for name in glyphs:
-        g_entry = glyphs[name]
+    glyphs = [(name, glyphs[name].bez_data) for name in glyphs]
+    for name, result in _hint_glyphs(options, glyphs, fontinfo_list):
         fontinfo, fddict, fdglyphdict = fontinfo_list[name]
 
         if fdglyphdict:
@@ -672,8 +733,7 @@ def hint_font(options, font, glyph_list, fontinfo_list):
         else:
             log.info("%s: Begin hinting.", aliases.get(name, name))
 
-        # Call auto-hint library on bez string.
-        new_bez_glyph = hint_glyph(options, name, g_entry.bez_data, fontinfo)
+        new_bez_glyph = result.get()
         options.baseMaster[name] = new_bez_glyph
 
         if not ("ry" in new_bez_glyph or "rb" in new_bez_glyph or
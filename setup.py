@@ -452,6 +452,7 @@ libraries = [
                 "libpsautohint/src/ac.c",
                 "libpsautohint/src/acfixed.c",
                 "libpsautohint/src/auto.c",
+                "libpsautohint/src/batch.c",
                 "libpsautohint/src/bbox.c",
                 "libpsautohint/src/buffer.c",
                 "libpsautohint/src/charpath.c",
@@ -520,6 +521,8 @@ ext_modules = [
         sources=[
             "python/psautohint/_psautohint.c",
         ],
+        # for the worker threads of AutoHintBatch()
+        libraries=["pthread"] if os.name != "nt" else [],
     ),
 ]
 
@@ -545,7 +548,8 @@ executables = [
         # when running gcc with --coverage):
         # https://travis-ci.org/adobe-type-tools/psautohint/jobs/423944212#L581
         # It should be ok if '-lpsautohint' is mentioned twice.
-        libraries=["psautohint"] + (["m"] if os.name != "nt" else []),
+        libraries=["psautohint"] + (["m", "pthread"] if os.name != "nt"
+                                    else []),
     ),
 ]
 
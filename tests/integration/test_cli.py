@@ -1,4 +1,5 @@
 import glob
+import logging
 import os
 from os.path import basename
 import subprocess
@@ -225,6 +226,88 @@ def test_argumentless_option(path, option, tmpdir):
     autohint([path, '-o', out, option])
 
 
+@pytest.mark.parametrize("jobs", ["1", "4"])
+@pytest.mark.parametrize("path", ["font.ufo", "font.otf"])
+def test_jobs(path, jobs, tmpdir):
+    path = "%s/dummy/%s" % (DATA_DIR, path)
+    out = str(tmpdir / basename(path)) + ".out"
+
+    autohint([path, '-o', out, '--jobs', jobs])
+
+
+def make_many_glyphs_font(path, count):
+    """Builds an OTF with count glyphs of varying stem widths."""
+    from fontTools.fontBuilder import FontBuilder
+    from fontTools.pens.t2CharStringPen import T2CharStringPen
+
+    names = [".notdef"] + ["g%03d" % i for i in range(count)]
+    charstrings = {}
+    for i, name in enumerate(names):
+        stem = 40 + (i * 7) % 50
+        pen = T2CharStringPen(600, None)
+        pen.moveTo((50, 0))
+        pen.lineTo((50, 700))
+        pen.lineTo((50 + stem, 700))
+        pen.lineTo((50 + stem, 0))
+        pen.closePath()
+        pen.moveTo((300, 0))
+        pen.curveTo((200, 0), (150, 150), (150, 350))
+        pen.curveTo((150, 550), (200, 700), (300, 700))
+        pen.lineTo((300, 700 - stem))
+        pen.curveTo((250, 700 - stem), (150 + stem, 550), (150 + stem, 350))
+        pen.curveTo((150 + stem, 150), (250, stem), (300, stem))
+        pen.closePath()
+        charstrings[name] = pen.getCharString()
+
+    fb = FontBuilder(1000, isTTF=False)
+    fb.setupGlyphOrder(names)
+    fb.setupCharacterMap({})
+    fb.setupCFF("Jobs-Regular", {"FullName": "Jobs Regular"}, charstrings,
+                {"BlueValues": [-15, 0, 700, 715],
+                 "StdHW": 60, "StdVW": 60})
+    fb.setupHorizontalMetrics({name: (600, 50) for name in names})
+    fb.setupHorizontalHeader(ascent=800, descent=-200)
+    fb.setupNameTable({"familyName": "Jobs", "styleName": "Regular"})
+    fb.setupOS2()
+    fb.setupPost()
+    fb.save(path)
+
+
+def test_jobs_deterministic(tmpdir, caplog):
+    # More glyphs than 4 jobs * 4 chunks, so each thread hints several chunks
+    path = str(tmpdir / "many.otf")
+    make_many_glyphs_font(path, 100)
+    caplog.set_level(logging.INFO)
+
+    outputs = {}
+    messages = {}
+    for jobs in ("1", "4", "0"):
+        caplog.clear()
+        out = str(tmpdir / ("many-%s.otf" % jobs))
+        autohint([path, '-o', out, '--verbose', '--jobs', jobs])
+        with open(out, "rb") as fp:
+            outputs[jobs] = fp.read()
+        # all but the start and end times
+        messages[jobs] = [(r.name, r.levelno, r.getMessage())
+                          for r in caplog.records
+                          if " time: " not in r.getMessage()]
+
+    assert any(name == "_psautohint" for name, _, _ in messages["1"])
+    assert outputs["4"] == outputs["1"]
+    assert outputs["0"] == outputs["1"]
+    assert messages["4"] == messages["1"]
+    assert messages["0"] == messages["1"]
+
+
+@pytest.mark.parametrize("jobs", ["-1", "two"])
+def test_invalid_jobs(jobs, tmpdir):
+    path = "%s/dummy/font.otf" % DATA_DIR
+    out = str(tmpdir / basename(path)) + ".out"
+
+    with pytest.raises(SystemExit):
+        autohint([path, '-o', out, '--jobs', jobs])
+
+
 def test_print_fddict(capsys):
     dummypath = os.path.join(DATA_DIR, "dummy")
     fontpath = os.path.join(dummypath, "font.otf")
@@ -291,6 +374,7 @@ def test_invalid_save_path(tmpdir):
     pytest.param([], id="report_stems"),
     pytest.param(['-a'], id="report_stems,all_stems"),
     pytest.param(['-g', 'a-z,A-Z,zero-nine'], id="report_stems,glyphs"),
+    pytest.param(['-j', '1'], id="report_stems,jobs"),
 ])
 def test_stemhist(args, tmpdir):
     path = "%s/dummy/font.otf" % DATA_DIR
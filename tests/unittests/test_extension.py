@@ -1,3 +1,6 @@
+import ctypes
+from concurrent.futures import ThreadPoolExecutor
+
 import pytest
 
 from psautohint import _psautohint
@@ -105,3 +108,279 @@ def test_autohintmm_bad_glyphs(glyphs):
 ])
 def test_autohint_too_many_counter_glyphs(info):
     _psautohint.autohint(info, GLYPH)
+
+
+def test_autohint_log_records():
+    records = []
+    with pytest.raises(_psautohint.error):
+        _psautohint.autohint(INFO, b"% foo\ncf", 1, 1, 1, 0, 0, records)
+    assert records
+    assert all(isinstance(level, int) and msg.startswith("foo: ")
+               for level, msg in records)
+
+
+def test_autohint_bad_log_records():
+    with pytest.raises(TypeError):
+        _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, ())
+
+
+@pytest.mark.parametrize("level", ["DEBUG", "WARNING"])
+def test_autohint_log_level(caplog, level):
+    with caplog.at_level(level, logger="_psautohint"):
+        _psautohint.autohint(INFO, GLYPH)
+    debug = [r for r in caplog.records if r.levelname == "DEBUG"]
+    assert bool(debug) == (level == "DEBUG")
+
+
+def test_autohint_log_records_level(caplog):
+    records = []
+    with caplog.at_level("WARNING", logger="_psautohint"):
+        _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, records)
+    assert not [level for level, _ in records if level < 30]
+
+    records = []
+    with caplog.at_level("DEBUG", logger="_psautohint"):
+        _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, records)
+    assert [level for level, _ in records if level == 10]
+
+
+def test_autohint_stats():
+    stats = {}
+    _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, None, stats)
+    assert stats["name"] == "square"
+    assert stats["segments"] > 0 and stats["hint_sets"] > 0
+    assert all(isinstance(value, int) for key, value in stats.items()
+               if key != "name")
+
+    with pytest.raises(TypeError):
+        _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, None, [])
+
+
+def curve_bbox(caplog, curve, analytic):
+    # a box outside the usual em is logged as bogus, which gives it to us
+    xs, ys = curve
+    pts = [(x + 2000, y) for x, y in zip(xs, ys)]
+    glyph = b"%% curve\n%d %d mt\n%d %d %d %d %d %d ct\ncp\ned\n" % (
+        sum(pts, ()))
+    caplog.clear()
+    with caplog.at_level("INFO", logger="_psautohint"):
+        _psautohint.autohint(INFO, glyph, 0, 1, 1, 0, 0, None, None, analytic)
+    boxes = [r.getMessage() for r in caplog.records
+             if "bounding box looks bogus" in r.getMessage()]
+    assert len(boxes) == 1
+    return [float(v) for v in boxes[0].rstrip(".").split(": ")[-1].split()]
+
+
+@pytest.mark.parametrize("curve", [
+    ((0, -150, 400, 300), (0, 300, -100, 200)),  # extremes in both directions
+    ((0, -100, 0, 300), (0, 100, 200, 300)),     # a == 0, b == 0 in y
+    ((0, -200, -200, 0), (0, 200, 400, 0)),      # a == 0 in both
+    ((0, 100, 200, -100), (0, 250, 0, 250)),     # b == 0 in x, disc == 0 in y
+    ((0, 100, 0, 100), (0, -100, -100, 0)),      # disc == 0 in x
+    ((0, 300, -50, 100), (0, 80, 90, 100)),      # two extremes in x
+    ((0, 1, 2, 3), (0, -1, 2, 3)),               # tiny
+])
+def test_autohint_analytic_bbox(caplog, curve):
+    flattened = curve_bbox(caplog, curve, 0)
+    analytic = curve_bbox(caplog, curve, 1)
+    assert all(abs(a - f) <= 1 for a, f in zip(analytic, flattened))
+
+
+@pytest.mark.parametrize("report", [0, 1, 2])
+def test_autohint_threads(report):
+    expected = _psautohint.autohint(INFO, GLYPH, 1, 1, 1, report)
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = executor.map(
+            lambda _: _psautohint.autohint(INFO, GLYPH, 1, 1, 1, report),
+            range(100))
+        assert all(result == expected for result in results)
+
+
+def test_autohint_counter_glyphs_per_font_info(caplog):
+    # only the messages the logger would log are recorded
+    caplog.set_level("INFO", logger="_psautohint")
+    records = []
+    info = INFO + b"\nHCounterChars ( square )"
+    _psautohint.autohint(info, GLYPH, 1, 1, 1, 0, 0, records)
+    assert any("counter hints" in msg for _, msg in records)
+
+    records = []
+    _psautohint.autohint(INFO, GLYPH, 1, 1, 1, 0, 0, records)
+    assert not any("counter hints" in msg for _, msg in records)
+
+
+def test_autohint_many_counter_glyphs(caplog):
+    # only the messages the logger would log are recorded
+    caplog.set_level("INFO", logger="_psautohint")
+    records = []
+    names = b" ".join(b"a%d" % i for i in range(100))
+    info = INFO + b"\nHCounterChars ( " + names + b" square )"
+    _psautohint.autohint(info, GLYPH, 1, 1, 1, 0, 0, records)
+    assert any("counter hints" in msg for _, msg in records)
+
+
+def square_bez(x, y, size, clockwise):
+    pts = [(x, y), (x, y + size), (x + size, y + size), (x + size, y)]
+    if not clockwise:
+        pts = pts[:1] + pts[:0:-1]
+    ops = ["%d %d mt" % pts[0]] + ["%d %d dt" % pt for pt in pts[1:]]
+    return "\n".join(ops) + "\ncp\n"
+
+
+# the "o" (outer) and "i" (inner) contours of each ring, by ring, in the
+# order the hinter moves them to, which is how the shuffling was done before
+# it gave up on glyphs with 100 subpaths or more
+SHUFFLED_RINGS = """
+o0 o26 i26 o1 o27 i27 o2 o28 i28 o3 o29 i29 o4 o30 i30 o5 o31 i31
+o6 o32 i32 o7 o33 i33 o8 o34 i34 o35 i35 o36 i36 o37 i37 o38 i38
+o39 i39 o40 i40 o41 i41 o42 i42 o43 i43 o44 i44 o45 i45 o46 i46
+o47 i47 o48 i48 o49 i49 o9 o10 o11 o12 o13 o14 o15 o16 i16 o17
+i17 o18 i18 o19 i19 o20 i20 o21 i21 o22 i22 o23 i23 o24 i24 o25
+i25 o50 i50 o51 i51 o52 i52 o53 i53 o54 i54 i0 i1 i2 i3 i4 i5 i6
+i7 i8 i9 i10 i11 i12 i13 i14 i15
+""".split()
+
+
+def test_autohint_shuffle_many_subpaths():
+    # 55 rings stacked up, all the outer contours first, then the inner ones
+    rings = range(55)
+    glyph = "% rings\nsc\n"
+    glyph += "".join(square_bez(0, 100 * i, 40, False) for i in rings)
+    glyph += "".join(square_bez(10, 100 * i + 10, 20, True) for i in rings)
+    glyph += "ed\n"
+
+    output = _psautohint.autohint(INFO, glyph.encode("ascii"))
+
+    order = []
+    for line in output.decode("ascii").splitlines():
+        if line.endswith(" mt"):
+            x, y = (int(v) for v in line.split()[:2])
+            order.append("%s%d" % ("o" if x in (0, 40) else "i", y // 100))
+    assert order == SHUFFLED_RINGS
+
+
+@pytest.mark.parametrize("threads", [1, 4, 0, -1])
+def test_autohintbatch(threads):
+    # squares of different sizes
+    glyphs = [GLYPH.replace(b"square", b"g%d" % i)
+                   .replace(b"560", b"%d" % (200 + 20 * i))
+              for i in range(20)]
+    glyphs[7] = b"% bad\ncf"
+    results = _psautohint.autohintbatch(INFO, tuple(glyphs), 1, 1, 1, threads)
+    assert len(results) == len(glyphs)
+    for i, (glyph, (status, hinted)) in enumerate(zip(glyphs, results)):
+        if i == 7:
+            assert status != 0 and hinted is None
+        else:
+            assert status == 0
+            assert hinted == _psautohint.autohint(INFO, glyph)
+
+
+PATH = [
+    ("mt", 560, 500),
+    ("dt", 560, 0),
+    ("dt", 60, 0),
+    ("dt", 60, 500),
+    ("cp",),
+]
+
+
+def test_autohintpath():
+    expected = _psautohint.autohint(INFO, GLYPH)
+    assert _psautohint.autohintpath(INFO, "square", PATH) == expected
+
+
+@pytest.mark.parametrize("path, exception", [
+    (None, TypeError),                       # not a sequence
+    ([["mt", 0, 0]], TypeError),             # element is not a tuple
+    ([("mt", 0)], ValueError),               # missing coordinate
+    ([("rmt", 0, 0)], ValueError),           # unknown operator
+    ([("mt", 0, "0")], TypeError),           # coordinate is not a number
+    ([("mt", 0, 1e10)], ValueError),         # coordinate out of range
+])
+def test_autohintpath_bad_path(path, exception):
+    with pytest.raises(exception):
+        _psautohint.autohintpath(INFO, "square", path)
+
+
+def test_autohintresult():
+    result = _psautohint.autohintresult(INFO, GLYPH)
+    assert result["name"] == "square"
+    assert result["hints"] == [("vstem", 60, 500, 2, 0),
+                               ("hstem", 0, 500, 1, 0)]
+    assert result["hint_sets"] == [(0, 0, 2)]
+    assert result["path"] == PATH
+    assert result["flex"] == []
+
+
+def test_autohintresult_bad_glyph():
+    with pytest.raises(_psautohint.error):
+        _psautohint.autohintresult(INFO, b"% foo\ncf")
+
+
+@pytest.fixture
+def lib():
+    # the library functions are linked into the extension, call them directly
+    lib = ctypes.CDLL(_psautohint.__file__)
+    if not hasattr(lib, "ACBufferWrap"):
+        pytest.skip("the library functions are not exported")
+    lib.ACBufferWrap.restype = ctypes.c_void_p
+    lib.ACBufferWrap.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+    lib.ACBufferFree.argtypes = [ctypes.c_void_p]
+    lib.ACBufferWrite.argtypes = [ctypes.c_void_p, ctypes.c_char_p,
+                                  ctypes.c_size_t]
+    lib.ACBufferWriteF.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    lib.ACBufferRead.argtypes = [ctypes.c_void_p,
+                                 ctypes.POINTER(ctypes.c_void_p),
+                                 ctypes.POINTER(ctypes.c_size_t)]
+    return lib
+
+
+def read_buffer(lib, buffer):
+    data, length = ctypes.c_void_p(), ctypes.c_size_t()
+    lib.ACBufferRead(buffer, ctypes.byref(data), ctypes.byref(length))
+    return data.value, ctypes.string_at(data, length.value)
+
+
+def test_buffer_wrap(lib):
+    storage = ctypes.create_string_buffer(64)
+    buffer = lib.ACBufferWrap(storage, len(storage))
+    lib.ACBufferWrite(buffer, b"hello ", 6)
+    lib.ACBufferWriteF(buffer, b"world")
+    # the data is still in the storage we gave
+    assert read_buffer(lib, buffer) == (ctypes.addressof(storage),
+                                        b"hello world")
+    assert storage.raw.startswith(b"hello world")
+    lib.ACBufferFree(buffer)
+
+    assert lib.ACBufferWrap(None, 64) is None
+    assert lib.ACBufferWrap(storage, 0) is None
+
+
+def test_buffer_wrap_too_small(lib):
+    storage = ctypes.create_string_buffer(4)
+    buffer = lib.ACBufferWrap(storage, len(storage))
+    lib.ACBufferWrite(buffer, b"hel", 3)
+    lib.ACBufferWrite(buffer, b"lo world", 8)
+    # the data moved to memory of the buffer's own, and freeing the buffer
+    # frees only that
+    data, value = read_buffer(lib, buffer)
+    assert data != ctypes.addressof(storage)
+    assert value == b"hello world"
+    lib.ACBufferFree(buffer)
+    assert storage.raw[:3] == b"hel"
+
+
+@pytest.mark.parametrize("text, moved", [
+    (b"abcdefg", False),   # fits with the terminating null
+    (b"abcdefgh", True),   # takes exactly the free space, formatted again
+    (b"abcdefghi", True),
+])
+def test_buffer_wrap_writef_fit(lib, text, moved):
+    storage = ctypes.create_string_buffer(8)
+    buffer = lib.ACBufferWrap(storage, len(storage))
+    lib.ACBufferWriteF(buffer, text)
+    data, value = read_buffer(lib, buffer)
+    assert value == text
+    assert (data != ctypes.addressof(storage)) == moved
+    lib.ACBufferFree(buffer)